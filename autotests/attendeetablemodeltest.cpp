@@ -0,0 +1,198 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "attendeetablemodeltest.h"
+#include "attendeetablemodel.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(AttendeeTableModelTest)
+
+using namespace IncidenceEditorNG;
+using namespace Qt::Literals::StringLiterals;
+
+namespace
+{
+KCalendarCore::Attendee makeAttendee(int i, KCalendarCore::Attendee::CuType cuType = KCalendarCore::Attendee::Individual)
+{
+    KCalendarCore::Attendee attendee(u"attendee %1"_s.arg(i), u"attendee%1@example.com"_s.arg(i));
+    attendee.setCuType(cuType);
+    return attendee;
+}
+
+// every third attendee is a resource and every seventh a room
+KCalendarCore::Attendee::List attendees(int count)
+{
+    KCalendarCore::Attendee::List list;
+    list.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        list.append(makeAttendee(i, i % 3 == 0 ? KCalendarCore::Attendee::Resource : i % 7 == 0 ? KCalendarCore::Attendee::Room : KCalendarCore::Attendee::Individual));
+    }
+    return list;
+}
+
+class RefilteringProxyModel : public AttendeeFilterProxyModel
+{
+public:
+    void refilter()
+    {
+        invalidateRowsFilter();
+    }
+};
+}
+
+void AttendeeTableModelTest::testInsertAttendees()
+{
+    AttendeeTableModel model;
+    model.setAttendees(attendees(2));
+    QSignalSpy inserted(&model, &AttendeeTableModel::rowsInserted);
+
+    model.insertAttendees(1, {makeAttendee(10), makeAttendee(11), makeAttendee(12)});
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 1);
+    QCOMPARE(inserted.at(0).at(2).toInt(), 3);
+
+    const KCalendarCore::Attendee::List list = model.attendees();
+    QCOMPARE(list.size(), 5);
+    QCOMPARE(list.at(0).email(), u"attendee0@example.com"_s);
+    QCOMPARE(list.at(1).email(), u"attendee10@example.com"_s);
+    QCOMPARE(list.at(3).email(), u"attendee12@example.com"_s);
+    QCOMPARE(list.at(4).email(), u"attendee1@example.com"_s);
+
+    model.insertAttendees(0, {});
+    QCOMPARE(inserted.count(), 1);
+}
+
+void AttendeeTableModelTest::testInsertAttendeesKeepsEmptyRow()
+{
+    AttendeeTableModel model;
+    model.setKeepEmpty(true);
+    model.setAttendees(attendees(2));
+    QCOMPARE(model.rowCount(), 3);
+    QSignalSpy inserted(&model, &AttendeeTableModel::rowsInserted);
+
+    // in front of the empty row, which stays the only one and the last one
+    model.insertAttendees(2, {makeAttendee(10), makeAttendee(11), makeAttendee(12)});
+    QCOMPARE(inserted.count(), 1);
+    QCOMPARE(inserted.at(0).at(1).toInt(), 2);
+    QCOMPARE(inserted.at(0).at(2).toInt(), 4);
+    QCOMPARE(model.rowCount(), 6);
+
+    const KCalendarCore::Attendee::List list = model.attendees();
+    QStringList emails;
+    for (const KCalendarCore::Attendee &attendee : list) {
+        emails.append(attendee.email());
+    }
+    QCOMPARE(emails,
+             QStringList({u"attendee0@example.com"_s,
+                          u"attendee1@example.com"_s,
+                          u"attendee10@example.com"_s,
+                          u"attendee11@example.com"_s,
+                          u"attendee12@example.com"_s,
+                          QString()}));
+    QVERIFY(list.constLast().fullName().isEmpty());
+}
+
+void AttendeeTableModelTest::testReplaceAttendees()
+{
+    AttendeeTableModel model;
+    model.setKeepEmpty(true);
+    model.setAttendees({makeAttendee(0), makeAttendee(1), makeAttendee(2), makeAttendee(3)});
+    model.setData(model.index(0, AttendeeTableModel::Available), AttendeeTableModel::Busy);
+    model.setData(model.index(3, AttendeeTableModel::Available), AttendeeTableModel::Free);
+    QSignalSpy reset(&model, &AttendeeTableModel::modelReset);
+    QSignalSpy inserted(&model, &AttendeeTableModel::rowsInserted);
+    QSignalSpy removed(&model, &AttendeeTableModel::rowsRemoved);
+
+    // two groups, one expanded into a resource and a person, one into nobody
+    QMap<int, KCalendarCore::Attendee::List> replacements;
+    replacements.insert(2, {makeAttendee(20, KCalendarCore::Attendee::Resource), makeAttendee(21)});
+    replacements.insert(1, {});
+    model.replaceAttendees(replacements);
+    QCOMPARE(reset.count(), 1);
+    QCOMPARE(inserted.count(), 0);
+    QCOMPARE(removed.count(), 0);
+
+    const KCalendarCore::Attendee::List list = model.attendees();
+    QStringList emails;
+    for (const KCalendarCore::Attendee &attendee : list) {
+        emails.append(attendee.email());
+    }
+    QCOMPARE(emails,
+             QStringList({u"attendee0@example.com"_s, u"attendee20@example.com"_s, u"attendee21@example.com"_s, u"attendee3@example.com"_s, QString()}));
+
+    // the rows kept keep their availability, the new ones start out unknown
+    QCOMPARE(model.data(model.index(0, AttendeeTableModel::Available), Qt::EditRole).toInt(), int(AttendeeTableModel::Busy));
+    QCOMPARE(model.data(model.index(1, AttendeeTableModel::Available), Qt::EditRole).toInt(), int(AttendeeTableModel::Unknown));
+    QCOMPARE(model.data(model.index(3, AttendeeTableModel::Available), Qt::EditRole).toInt(), int(AttendeeTableModel::Free));
+    QVERIFY(model.isResource(1));
+    QVERIFY(!model.isResource(2));
+    QVERIFY(!model.isResource(3));
+}
+
+void AttendeeTableModelTest::testResourcePartition()
+{
+    AttendeeTableModel model;
+    ResourceFilterProxyModel resources;
+    resources.setSourceModel(&model);
+    AttendeeFilterProxyModel people;
+    people.setSourceModel(&model);
+
+    model.setAttendees(attendees(8)); // resources at 0, 3 and 6, a room at 7
+    QCOMPARE(resources.rowCount(), 4);
+    QCOMPARE(people.rowCount(), 4);
+    QVERIFY(model.isResource(0));
+    QVERIFY(!model.isResource(1));
+    QVERIFY(model.isResource(7));
+
+    model.insertAttendees(1, {makeAttendee(20, KCalendarCore::Attendee::Room), makeAttendee(21)});
+    QVERIFY(model.isResource(1));
+    QVERIFY(!model.isResource(2));
+    QVERIFY(!model.isResource(3));
+    QVERIFY(model.isResource(5));
+    QCOMPARE(resources.rowCount(), 5);
+    QCOMPARE(people.rowCount(), 5);
+
+    model.removeRows(0, 2);
+    QVERIFY(!model.isResource(0));
+    QVERIFY(model.isResource(3));
+    QCOMPARE(resources.rowCount(), 3);
+    QCOMPARE(people.rowCount(), 5);
+
+    // the proxies follow a changed user type
+    model.setData(model.index(0, AttendeeTableModel::CuType), KCalendarCore::Attendee::Resource);
+    QVERIFY(model.isResource(0));
+    QCOMPARE(resources.rowCount(), 4);
+    QCOMPARE(people.rowCount(), 4);
+
+    model.insertRows(0, 1);
+    QVERIFY(!model.isResource(0));
+    QVERIFY(model.isResource(1));
+}
+
+void AttendeeTableModelTest::benchmarkRefilter_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("100") << 100;
+    QTest::newRow("5000") << 5000;
+}
+
+void AttendeeTableModelTest::benchmarkRefilter()
+{
+    QFETCH(int, count);
+    AttendeeTableModel model;
+    model.setAttendees(attendees(count));
+    RefilteringProxyModel proxy;
+    proxy.setSourceModel(&model);
+
+    QBENCHMARK {
+        proxy.refilter();
+        QVERIFY(proxy.rowCount() > 0);
+    }
+}
+
+#include "moc_attendeetablemodeltest.cpp"
@@ -0,0 +1,21 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class AttendeeTableModelTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testInsertAttendees();
+    void testInsertAttendeesKeepsEmptyRow();
+    void testReplaceAttendees();
+    void testResourcePartition();
+    void benchmarkRefilter_data();
+    void benchmarkRefilter();
+};
@@ -0,0 +1,85 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "attendeeutilstest.h"
+#include "attendeeutils.h"
+
+#include <QTest>
+
+#include <algorithm>
+
+QTEST_GUILESS_MAIN(AttendeeUtilsTest)
+
+using namespace IncidenceEditorNG;
+using namespace Qt::Literals::StringLiterals;
+
+namespace
+{
+KCalendarCore::Attendee::List attendees(int count)
+{
+    KCalendarCore::Attendee::List list;
+    list.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        list.append(KCalendarCore::Attendee(u"attendee %1"_s.arg(i), u"attendee%1@example.com"_s.arg(i)));
+    }
+    return list;
+}
+}
+
+void AttendeeUtilsTest::testSameAttendees()
+{
+    const KCalendarCore::Attendee::List original = attendees(5);
+    QVERIFY(sameAttendees({}, {}));
+    QVERIFY(sameAttendees(original, original));
+
+    KCalendarCore::Attendee::List reversed = original;
+    std::reverse(reversed.begin(), reversed.end());
+    QVERIFY(sameAttendees(original, reversed));
+
+    QVERIFY(!sameAttendees(original, attendees(4)));
+
+    // any changed field counts, not just the address
+    KCalendarCore::Attendee::List changed = original;
+    changed[2].setStatus(KCalendarCore::Attendee::Accepted);
+    QVERIFY(!sameAttendees(original, changed));
+    changed = original;
+    changed[2].setRSVP(true);
+    QVERIFY(!sameAttendees(original, changed));
+
+    // duplicates are counted
+    KCalendarCore::Attendee::List duplicated = original;
+    duplicated[4] = duplicated[0];
+    QVERIFY(!sameAttendees(original, duplicated));
+    QVERIFY(!sameAttendees(duplicated, original));
+    KCalendarCore::Attendee::List duplicatedReversed = duplicated;
+    std::reverse(duplicatedReversed.begin(), duplicatedReversed.end());
+    QVERIFY(sameAttendees(duplicated, duplicatedReversed));
+}
+
+void AttendeeUtilsTest::benchmarkSameAttendees_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10 attendees") << 10;
+    QTest::newRow("1000 attendees") << 1000;
+    QTest::newRow("10000 attendees") << 10000;
+}
+
+void AttendeeUtilsTest::benchmarkSameAttendees()
+{
+    QFETCH(int, count);
+    // the worst case for the lookups, every attendee is compared and matched
+    const KCalendarCore::Attendee::List original = attendees(count);
+    KCalendarCore::Attendee::List edited = original;
+    std::reverse(edited.begin(), edited.end());
+
+    bool same = false;
+    QBENCHMARK {
+        same = sameAttendees(original, edited);
+    }
+    QVERIFY(same);
+}
+
+#include "moc_attendeeutilstest.cpp"
@@ -0,0 +1,91 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "busyintervalindextest.h"
+#include "busyintervalindex.h"
+
+#include <QDateTime>
+#include <QTest>
+#include <QTimeZone>
+
+QTEST_GUILESS_MAIN(BusyIntervalIndexTest)
+
+using namespace IncidenceEditorNG;
+
+namespace
+{
+const QDateTime start(QDate(2026, 1, 5), QTime(8, 0), QTimeZone::utc());
+const qint64 hour = 60 * 60 * 1000;
+
+KCalendarCore::Period hours(int from, int to)
+{
+    return KCalendarCore::Period(start.addSecs(from * 60 * 60), start.addSecs(to * 60 * 60));
+}
+
+qint64 at(int hour)
+{
+    return start.addSecs(hour * 60 * 60).toMSecsSinceEpoch();
+}
+
+// unsorted and overlapping, [0, 3) and [3, 4) only touch
+BusyIntervalIndex index()
+{
+    return BusyIntervalIndex(KCalendarCore::Period::List() << hours(6, 7) << hours(1, 3) << hours(0, 2) << hours(3, 4));
+}
+}
+
+void BusyIntervalIndexTest::testNextFree()
+{
+    QVERIFY(BusyIntervalIndex().isEmpty());
+    QCOMPARE(BusyIntervalIndex().nextFree(at(0), hour), at(0));
+
+    const BusyIntervalIndex busy = index();
+    QCOMPARE(busy.size(), 3);
+    QCOMPARE(busy.nextFree(at(-2), hour), at(-2));
+    QCOMPARE(busy.nextFree(at(-1), 2 * hour), at(4));
+    QCOMPARE(busy.nextFree(at(1), hour), at(4));
+    QCOMPARE(busy.nextFree(at(4), 2 * hour), at(4));
+    QCOMPARE(busy.nextFree(at(4), 3 * hour), at(7));
+    QCOMPARE(busy.nextFree(at(3), 0), at(3));
+}
+
+void BusyIntervalIndexTest::testNextCommonFree()
+{
+    const BusyIntervalIndex other(KCalendarCore::Period::List() << hours(4, 5) << hours(7, 9));
+    const QList<BusyIntervalIndex> indexes{index(), other};
+    QCOMPARE(BusyIntervalIndex::nextCommonFree(indexes, at(0), hour, at(100)), at(5));
+    QCOMPARE(BusyIntervalIndex::nextCommonFree(indexes, at(0), 2 * hour, at(100)), at(9));
+    QVERIFY(BusyIntervalIndex::nextCommonFree(indexes, at(0), 2 * hour, at(8)) > at(8));
+    QCOMPARE(BusyIntervalIndex::nextCommonFree({}, at(0), hour, at(0)), at(0));
+
+    // running out of steps gives up before the common free slot is reached
+    BusyIntervalIndex::Budget budget;
+    budget.steps = 1;
+    (void)BusyIntervalIndex::nextCommonFree(indexes, at(0), 2 * hour, at(100), &budget);
+    QVERIFY(budget.exhausted);
+}
+
+void BusyIntervalIndexTest::testOverlaps()
+{
+    QVERIFY(!BusyIntervalIndex().overlaps(at(1), at(2)));
+
+    // unsorted, and the long first meeting ends after the short second one
+    const BusyIntervalIndex busy(KCalendarCore::Period::List() << hours(6, 7) << hours(0, 4) << hours(1, 2));
+    QCOMPARE(busy.size(), 2);
+
+    QVERIFY(!busy.overlaps(at(-2), at(-1)));
+    QVERIFY(!busy.overlaps(at(4), at(5)));
+    QVERIFY(!busy.overlaps(at(8), at(9)));
+    // lapping into the meeting
+    QVERIFY(busy.overlaps(at(3), at(5)));
+    QVERIFY(busy.overlaps(at(2), at(2) + hour / 2));
+    // starting in the meeting, the end counts
+    QVERIFY(busy.overlaps(at(5), at(6)));
+    QVERIFY(busy.overlaps(at(6), at(6) + hour / 4));
+    // starting at the end of the meeting does not
+    QVERIFY(!busy.overlaps(at(4), at(4) + hour / 2));
+    QVERIFY(!busy.overlaps(at(7), at(8)));
+}
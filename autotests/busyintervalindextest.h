@@ -0,0 +1,18 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class BusyIntervalIndexTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testNextFree();
+    void testNextCommonFree();
+    void testOverlaps();
+};
@@ -0,0 +1,348 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "conflictresolverbenchmark.h"
+#include "conflictresolver.h"
+
+#include <KCalendarCore/Attendee>
+#include <KCalendarCore/FreeBusy>
+#include <KCalendarCore/Period>
+
+#include <QBitArray>
+#include <QRandomGenerator>
+#include <QSignalSpy>
+#include <QTest>
+#include <QWidget>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+using namespace IncidenceEditorNG;
+using namespace Qt::Literals::StringLiterals;
+
+namespace
+{
+// Every allocation of the process, the resolver's worker threads included,
+// is counted, so allocations() can report what one operation costs and
+// tiledPeakMemory() how much memory it takes at most.
+std::atomic<quint64> allocatedBytes{0};
+std::atomic<qint64> usedBytes{0}; //!< usable sizes of the blocks not freed yet
+std::atomic<qint64> peakBytes{0};
+}
+
+#if defined(__GLIBC__)
+namespace
+{
+void *counted(void *ptr, size_t size)
+{
+    if (ptr) {
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        const auto usable = qint64(malloc_usable_size(ptr));
+        const qint64 used = usedBytes.fetch_add(usable, std::memory_order_relaxed) + usable;
+        qint64 peak = peakBytes.load(std::memory_order_relaxed);
+        while (used > peak && !peakBytes.compare_exchange_weak(peak, used, std::memory_order_relaxed)) { }
+    }
+    return ptr;
+}
+
+void released(void *ptr)
+{
+    if (ptr) {
+        usedBytes.fetch_sub(qint64(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    }
+}
+}
+
+// Qt's containers and strings allocate with malloc() and realloc() directly,
+// and operator new ends up in malloc() as well, so the allocation functions of
+// the C library are replaced. glibc exports the original ones under __libc_ names.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+void __libc_free(void *ptr);
+
+void *malloc(size_t size) noexcept
+{
+    return counted(__libc_malloc(size), size);
+}
+
+void *calloc(size_t count, size_t size) noexcept
+{
+    return counted(__libc_calloc(count, size), count * size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+    // the old block is gone unless realloc() fails
+    const qint64 oldUsable = ptr ? qint64(malloc_usable_size(ptr)) : 0;
+    void *const result = __libc_realloc(ptr, size);
+    if (result || size == 0) {
+        usedBytes.fetch_sub(oldUsable, std::memory_order_relaxed);
+    }
+    return counted(result, size);
+}
+
+void *memalign(size_t alignment, size_t size) noexcept
+{
+    return counted(__libc_memalign(alignment, size), size);
+}
+
+void *aligned_alloc(size_t alignment, size_t size) noexcept
+{
+    return counted(__libc_memalign(alignment, size), size);
+}
+
+int posix_memalign(void **ptr, size_t alignment, size_t size) noexcept
+{
+    void *const result = counted(__libc_memalign(alignment, size), size);
+    if (!result) {
+        return ENOMEM;
+    }
+    *ptr = result;
+    return 0;
+}
+
+void free(void *ptr) noexcept
+{
+    released(ptr);
+    __libc_free(ptr);
+}
+}
+#endif
+
+void ConflictResolverBenchmark::initTestCase()
+{
+    mParent = new QWidget;
+}
+
+void ConflictResolverBenchmark::cleanupTestCase()
+{
+    delete mParent;
+    mParent = nullptr;
+}
+
+void ConflictResolverBenchmark::init()
+{
+    mResolver = new ConflictResolver(mParent, mParent);
+}
+
+void ConflictResolverBenchmark::cleanup()
+{
+    delete mResolver;
+    mResolver = nullptr;
+}
+
+QDateTime ConflictResolverBenchmark::start() const
+{
+    return QDateTime(QDate(2026, 1, 5), QTime(0, 0)); // a Monday
+}
+
+QList<CalendarSupport::FreeBusyItem::Ptr> ConflictResolverBenchmark::generateAttendees(int count, int days) const
+{
+    // Up to four meetings per attendee and working day, between 8:00 and 18:00,
+    // in steps of 15 minutes. Seeded, so every run sees the same data.
+    QRandomGenerator random(quint32(count) * 1000 + quint32(days));
+    QList<CalendarSupport::FreeBusyItem::Ptr> items;
+    items.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        KCalendarCore::Period::List periods;
+        for (int day = 0; day < days; ++day) {
+            const QDate date = start().date().addDays(day);
+            if (date.dayOfWeek() > 5) {
+                continue;
+            }
+            const int meetings = random.bounded(5);
+            for (int meeting = 0; meeting < meetings; ++meeting) {
+                const QDateTime meetingStart(date, QTime(8, 0).addSecs(random.bounded(40) * 15 * 60));
+                periods << KCalendarCore::Period(meetingStart, meetingStart.addSecs((random.bounded(8) + 1) * 15 * 60));
+            }
+        }
+        const KCalendarCore::Attendee attendee(u"attendee %1"_s.arg(i), u"attendee%1@example.com"_s.arg(i), false, KCalendarCore::Attendee::Accepted);
+        CalendarSupport::FreeBusyItem::Ptr const item(new CalendarSupport::FreeBusyItem(attendee, nullptr));
+        item->setFreeBusy(KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(periods)));
+        items << item;
+    }
+    return items;
+}
+
+void ConflictResolverBenchmark::addScenarios(const QString &operation)
+{
+    // allocations() adds the operation column in front of these
+    if (operation.isEmpty()) {
+        QTest::addColumn<int>("attendees");
+        QTest::addColumn<int>("days");
+        QTest::addColumn<int>("resolution");
+    }
+
+    const QList<int> attendeeCounts{10, 100, 1000};
+    const QList<int> windows{1, 7, 30, 365};
+    const QList<int> resolutions{5, 15, 60};
+    for (int attendees : attendeeCounts) {
+        for (int days : windows) {
+            for (int resolution : resolutions) {
+                const QString name = u"%1 attendees, %2 days, %3 min"_s.arg(attendees).arg(days).arg(resolution);
+                if (operation.isEmpty()) {
+                    QTest::newRow(qPrintable(name)) << attendees << days << resolution * 60;
+                } else {
+                    QTest::newRow(qPrintable(operation + u", "_s + name)) << operation << attendees << days << resolution * 60;
+                }
+            }
+        }
+    }
+}
+
+bool ConflictResolverBenchmark::setUpResolver()
+{
+    QFETCH(int, attendees);
+    QFETCH(int, days);
+    QFETCH(int, resolution);
+
+    const QList<CalendarSupport::FreeBusyItem::Ptr> items = generateAttendees(attendees, days);
+    for (const CalendarSupport::FreeBusyItem::Ptr &item : items) {
+        mResolver->insertAttendee(item);
+    }
+    mResolver->setAllowedWeekdays(QBitArray(7, true));
+    mResolver->setResolution(resolution);
+    mResolver->setEarliestDateTime(start());
+    mResolver->setLatestDateTime(start().addDays(days));
+    mResolver->setSearchHorizon(days);
+
+    // let the calculation triggered by the changes above finish first
+    QSignalSpy conflictsDetected(mResolver, &ConflictResolver::conflictsDetected);
+    return conflictsDetected.wait(60 * 1000);
+}
+
+void ConflictResolverBenchmark::findAllFreeSlots_data()
+{
+    addScenarios();
+}
+
+void ConflictResolverBenchmark::findAllFreeSlots()
+{
+    QVERIFY(setUpResolver());
+    QBENCHMARK {
+        mResolver->findAllFreeSlots();
+    }
+}
+
+void ConflictResolverBenchmark::findFreeSlot_data()
+{
+    addScenarios();
+}
+
+void ConflictResolverBenchmark::findFreeSlot()
+{
+    QVERIFY(setUpResolver());
+    // a one hour meeting at 10:00 on the first day, which is often taken
+    const QDateTime meetingStart = start().addSecs(10 * 60 * 60);
+    const KCalendarCore::Period meeting(meetingStart, meetingStart.addSecs(60 * 60));
+    QBENCHMARK {
+        (void)mResolver->findFreeSlot(meeting);
+    }
+}
+
+void ConflictResolverBenchmark::calculateConflicts_data()
+{
+    addScenarios();
+}
+
+void ConflictResolverBenchmark::calculateConflicts()
+{
+    QVERIFY(setUpResolver());
+    // the whole round trip: scheduling, the search on the worker thread and the result
+    QSignalSpy conflictsDetected(mResolver, &ConflictResolver::conflictsDetected);
+    QBENCHMARK {
+        mResolver->freebusyDataChanged();
+        QVERIFY(conflictsDetected.wait(60 * 1000));
+    }
+}
+
+void ConflictResolverBenchmark::allocations_data()
+{
+    QTest::addColumn<QString>("operation");
+    QTest::addColumn<int>("attendees");
+    QTest::addColumn<int>("days");
+    QTest::addColumn<int>("resolution");
+
+    addScenarios(u"findAllFreeSlots"_s);
+    addScenarios(u"findFreeSlot"_s);
+    addScenarios(u"calculateConflicts"_s);
+}
+
+void ConflictResolverBenchmark::allocations()
+{
+#if !defined(__GLIBC__)
+    QSKIP("Counting allocations needs the allocation functions of glibc");
+#endif
+    QFETCH(QString, operation);
+    QVERIFY(setUpResolver());
+
+    const QDateTime meetingStart = start().addSecs(10 * 60 * 60);
+    const KCalendarCore::Period meeting(meetingStart, meetingStart.addSecs(60 * 60));
+    QSignalSpy conflictsDetected(mResolver, &ConflictResolver::conflictsDetected);
+
+    const quint64 before = allocatedBytes.load();
+    if (operation == "findAllFreeSlots"_L1) {
+        mResolver->findAllFreeSlots();
+    } else if (operation == "findFreeSlot"_L1) {
+        (void)mResolver->findFreeSlot(meeting);
+    } else {
+        mResolver->freebusyDataChanged();
+        QVERIFY(conflictsDetected.wait(60 * 1000));
+    }
+    QTest::setBenchmarkResult(qreal(allocatedBytes.load() - before), QTest::BytesAllocated);
+}
+
+void ConflictResolverBenchmark::tiledPeakMemory()
+{
+#if !defined(__GLIBC__)
+    QSKIP("Measuring the memory in use needs the allocation functions of glibc");
+#endif
+    // The busy periods only cover the first 30 days, so searching a year instead
+    // of a month only adds one long free slot. At one minute resolution a year
+    // has 525600 slots, anything kept per slot would show up in the difference.
+    mResolver->setFreeSlotEngine(ConflictResolver::TiledEngine);
+    const QList<CalendarSupport::FreeBusyItem::Ptr> items = generateAttendees(100, 30);
+    for (const CalendarSupport::FreeBusyItem::Ptr &item : items) {
+        mResolver->insertAttendee(item);
+    }
+    mResolver->setAllowedWeekdays(QBitArray(7, true));
+    mResolver->setResolution(60);
+    mResolver->setEarliestDateTime(start());
+
+    // the peak above what was in use before the search
+    const auto searchPeak = [this](int days) -> qint64 {
+        QSignalSpy conflictsDetected(mResolver, &ConflictResolver::conflictsDetected);
+        mResolver->setLatestDateTime(start().addDays(days));
+        if (!conflictsDetected.wait(60 * 1000)) {
+            return -1;
+        }
+        const qint64 before = usedBytes.load();
+        peakBytes.store(before);
+        mResolver->findAllFreeSlots();
+        return peakBytes.load() - before;
+    };
+    const qint64 month = searchPeak(30);
+    const qint64 year = searchPeak(365);
+    QVERIFY(month >= 0);
+    QVERIFY(year >= 0);
+
+    // less than a single bitmap over the whole year
+    const qint64 yearBitmapBytes = 365 * 24 * 60 / 8;
+    QVERIFY2(year - month < yearBitmapBytes, qPrintable(u"month: %1 bytes, year: %2 bytes"_s.arg(month).arg(year)));
+    QTest::setBenchmarkResult(qreal(year), QTest::BytesAllocated);
+}
+
+QTEST_MAIN(ConflictResolverBenchmark)
+
+#include "moc_conflictresolverbenchmark.cpp"
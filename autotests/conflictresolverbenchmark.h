@@ -0,0 +1,58 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <CalendarSupport/FreeBusyItem>
+
+#include <QDateTime>
+#include <QObject>
+
+namespace IncidenceEditorNG
+{
+class ConflictResolver;
+}
+
+/*
+ * Benchmarks the free slot search of ConflictResolver on synthetic free/busy
+ * data, for 10 to 1000 attendees over one day to one year.
+ *
+ * allocations() reports the bytes requested from malloc() and its siblings
+ * by one operation, tiledPeakMemory() the most memory in use at a time while
+ * TiledEngine searches a year at one minute resolution, and verifies it
+ * hardly differs from searching a month. Both need glibc.
+ *
+ * Not run by ctest. To compare runs, let QTest write the results as CSV:
+ *   conflictresolverbenchmark -o results.csv,csv
+ * or as JUnit XML with -o results.xml,junitxml.
+ */
+class ConflictResolverBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+    void cleanup();
+    void findAllFreeSlots_data();
+    void findAllFreeSlots();
+    void findFreeSlot_data();
+    void findFreeSlot();
+    void calculateConflicts_data();
+    void calculateConflicts();
+    void allocations_data();
+    void allocations();
+    void tiledPeakMemory();
+
+private:
+    void addScenarios(const QString &operation = QString());
+    [[nodiscard]] bool setUpResolver();
+    [[nodiscard]] QList<CalendarSupport::FreeBusyItem::Ptr> generateAttendees(int count, int days) const;
+    [[nodiscard]] QDateTime start() const;
+
+    QWidget *mParent = nullptr;
+    IncidenceEditorNG::ConflictResolver *mResolver = nullptr;
+};
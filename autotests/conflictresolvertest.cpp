@@ -7,12 +7,21 @@
 
 #include "conflictresolvertest.h"
 #include "conflictresolver.h"
+#include "freebusycache.h"
+
+#include <CalendarSupport/FreeBusyItemModel>
 
 #include <KCalendarCore/Duration>
 #include <KCalendarCore/Event>
+#include <KCalendarCore/FreeBusyPeriod>
 #include <KCalendarCore/Period>
+#include <KCalendarCore/Recurrence>
 
+#include <QBitArray>
+#include <QSignalSpy>
+#include <QStandardPaths>
 #include <QTest>
+#include <QTimeZone>
 #include <QWidget>
 
 using namespace IncidenceEditorNG;
@@ -35,6 +44,7 @@ void ConflictResolverTest::addAttendee(const QString &email, const KCalendarCore
 
 void ConflictResolverTest::initTestCase()
 {
+    QStandardPaths::setTestModeEnabled(true);
     parent = new QWidget;
     init();
 }
@@ -278,6 +288,573 @@ void ConflictResolverTest::testPeriodEndsAtSametimeAsTimeframe()
     QCOMPARE(resolver->availableSlots().size(), 0);
 }
 
+void ConflictResolverTest::testFreeSlotsAcrossWordBoundaries()
+{
+    // Two days at 15 minutes resolution are 192 slots, so the busy table spans
+    // several 64 slot words. Slot 64 is at 16:00 on the first day.
+    base.setDate(QDate(2010, 7, 29));
+    base.setTime(QTime(0, 0));
+    end = base.addDays(2);
+
+    const QDateTime nextDay = base.addDays(1);
+    KCalendarCore::Period const morning(_time(7, 45), _time(9, 0));
+    // not aligned to the resolution, and crossing the first word boundary
+    KCalendarCore::Period const afternoon(_time(15, 50), _time(16, 20));
+    KCalendarCore::Period const nextDayBusy(nextDay, nextDay.addSecs(23 * 60 * 60));
+
+    addAttendee(u"kdabtest1@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << morning)));
+    addAttendee(u"kdabtest2@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << afternoon)));
+    addAttendee(u"kdabtest3@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << nextDayBusy)));
+
+    insertAttendees();
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+    resolver->findAllFreeSlots();
+
+    const KCalendarCore::Period::List slots = resolver->availableSlots();
+    QCOMPARE(slots.size(), 4);
+    QCOMPARE(slots.at(0).start(), base);
+    QCOMPARE(slots.at(0).end(), _time(7, 45));
+    QCOMPARE(slots.at(1).start(), _time(9, 0));
+    QCOMPARE(slots.at(1).end(), _time(15, 45));
+    QCOMPARE(slots.at(2).start(), _time(16, 15));
+    QCOMPARE(slots.at(2).end(), nextDay);
+    QCOMPARE(slots.at(3).start(), nextDay.addSecs(23 * 60 * 60));
+    QCOMPARE(slots.at(3).end(), end);
+}
+
+void ConflictResolverTest::testEnginesAgree_data()
+{
+    QTest::addColumn<QDateTime>("from");
+    QTest::addColumn<QDateTime>("to");
+    QTest::addColumn<int>("resolution");
+    QTest::addColumn<QBitArray>("weekdays");
+    QTest::addColumn<QList<KCalendarCore::Period::List>>("busy");
+
+    const QDate day(2010, 7, 29); // a Thursday
+    const auto at = [day](int days, int h, int m) {
+        return QDateTime(day.addDays(days), QTime(h, m));
+    };
+    QBitArray allDays(7, true);
+    QBitArray workDays(7);
+    for (int i = 0; i < 5; ++i) {
+        workDays.setBit(i);
+    }
+
+    QTest::newRow("akademy") << at(0, 9, 30) << at(0, 17, 30) << 5 * 60 << allDays
+                             << QList<KCalendarCore::Period::List>{
+                                    {{at(0, 9, 30), at(0, 10, 30)}, {at(0, 11, 15), at(0, 11, 45)}, {at(0, 12, 45), at(0, 13, 15)}},
+                                    {{at(0, 9, 30), at(0, 9, 45)}, {at(0, 10, 30), at(0, 11, 15)}, {at(0, 12, 0), at(0, 12, 45)}},
+                                    {{at(0, 11, 15), at(0, 11, 45)}, {at(0, 13, 15), at(0, 13, 45)}, {at(0, 15, 15), at(0, 16, 0)}},
+                                };
+    QTest::newRow("unaligned") << at(0, 0, 0) << at(2, 0, 0) << 15 * 60 << allDays
+                               << QList<KCalendarCore::Period::List>{
+                                      {{at(0, 7, 50), at(0, 9, 5)}, {at(0, 15, 52), at(0, 16, 21)}},
+                                      {{at(0, 16, 0), at(0, 16, 7)}, {at(1, 3, 3), at(1, 4, 58)}},
+                                      {{at(1, 0, 0), at(1, 23, 0)}},
+                                  };
+    QTest::newRow("outside timeframe") << at(0, 7, 30) << at(0, 9, 30) << 15 * 60 << allDays
+                                       << QList<KCalendarCore::Period::List>{
+                                              {{at(0, 5, 45), at(0, 7, 45)}, {at(0, 9, 0), at(0, 10, 0)}},
+                                              {{at(-1, 12, 0), at(-1, 13, 0)}, {at(1, 12, 0), at(1, 13, 0)}},
+                                          };
+    QTest::newRow("weekdays") << at(0, 8, 0) << at(14, 8, 0) << 30 * 60 << workDays
+                              << QList<KCalendarCore::Period::List>{
+                                     // unsorted, overlapping, and spanning a weekend
+                                     {{at(8, 9, 0), at(8, 12, 0)}, {at(1, 18, 0), at(4, 10, 0)}, {at(8, 11, 0), at(8, 14, 0)}},
+                                     {{at(-3, 0, 0), at(0, 9, 0)}, {at(13, 17, 0), at(15, 0, 0)}},
+                                 };
+}
+
+void ConflictResolverTest::testEnginesAgree()
+{
+    QFETCH(QDateTime, from);
+    QFETCH(QDateTime, to);
+    QFETCH(int, resolution);
+    QFETCH(QBitArray, weekdays);
+    QFETCH(QList<KCalendarCore::Period::List>, busy);
+
+    for (const KCalendarCore::Period::List &periods : std::as_const(busy)) {
+        addAttendee(u"attendee%1@example.com"_s.arg(attendees.count()), KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(periods)));
+    }
+    insertAttendees();
+    resolver->setResolution(resolution);
+    resolver->setAllowedWeekdays(weekdays);
+    resolver->setEarliestDateTime(from);
+    resolver->setLatestDateTime(to);
+
+    resolver->setFreeSlotEngine(ConflictResolver::BitmapEngine);
+    resolver->findAllFreeSlots();
+    const KCalendarCore::Period::List bitmapSlots = resolver->availableSlots();
+    QVERIFY(!bitmapSlots.isEmpty());
+
+    resolver->setFreeSlotEngine(ConflictResolver::SweepEngine);
+    resolver->findAllFreeSlots();
+    QCOMPARE(resolver->availableSlots(), bitmapSlots);
+
+    // small tiles which do not line up with anything, so runs get stitched a lot
+    for (int tileSize : {1, 7, 64, 100000}) {
+        resolver->setFreeSlotEngine(ConflictResolver::TiledEngine);
+        resolver->setTileSize(tileSize);
+        resolver->findAllFreeSlots();
+        QCOMPARE(resolver->availableSlots(), bitmapSlots);
+    }
+
+    resolver->setFreeSlotEngine(ConflictResolver::AutomaticEngine);
+    resolver->findAllFreeSlots();
+    QCOMPARE(resolver->availableSlots(), bitmapSlots);
+}
+
+void ConflictResolverTest::testCachedRowsFollowChanges()
+{
+    base.setDate(QDate(2010, 7, 29)); // a Thursday
+    base.setTime(QTime(8, 0));
+    end = base.addDays(7);
+
+    KCalendarCore::Period const meeting1(_time(9, 0), _time(10, 0));
+    KCalendarCore::Period const meeting2(base.addDays(1), base.addDays(2));
+    addAttendee(u"kdabtest1@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << meeting1)));
+    addAttendee(u"kdabtest2@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << meeting2)));
+    insertAttendees();
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+
+    // Compares the cached bitmap rows against a search done from scratch.
+    const auto verifyAgainstSweep = [this]() {
+        resolver->setFreeSlotEngine(ConflictResolver::BitmapEngine);
+        resolver->findAllFreeSlots();
+        const KCalendarCore::Period::List bitmapSlots = resolver->availableSlots();
+        resolver->setFreeSlotEngine(ConflictResolver::SweepEngine);
+        resolver->findAllFreeSlots();
+        QCOMPARE(bitmapSlots, resolver->availableSlots());
+    };
+
+    verifyAgainstSweep();
+
+    QBitArray workDays(7);
+    for (int i = 0; i < 5; ++i) {
+        workDays.setBit(i);
+    }
+    resolver->setAllowedWeekdays(workDays);
+    verifyAgainstSweep();
+
+    resolver->removeAttendee(attendees.constLast()->attendee());
+    verifyAgainstSweep();
+
+    resolver->setResolution(30 * 60);
+    verifyAgainstSweep();
+}
+
+void ConflictResolverTest::testLatestCalculationWins()
+{
+    KCalendarCore::Period const meeting(base.addSecs(2 * 60 * 60), base.addSecs(3 * 60 * 60));
+    addAttendee(u"kdabtest1@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << meeting)));
+    addAttendee(u"kdabtest2@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List())));
+    insertAttendees();
+
+    QSignalSpy conflictsSpy(resolver, &ConflictResolver::conflictsDetected);
+    QSignalSpy slotsSpy(resolver, &ConflictResolver::freeSlotsAvailable);
+
+    // a series of quick changes only delivers the results for the last one
+    resolver->setEarliestDateTime(base.addDays(1));
+    resolver->setLatestDateTime(end.addDays(1));
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+
+    QVERIFY(conflictsSpy.wait());
+    QCOMPARE(conflictsSpy.count(), 1);
+    QCOMPARE(conflictsSpy.at(0).at(0).toInt(), 1);
+    QCOMPARE(slotsSpy.count(), 1);
+
+    const KCalendarCore::Period::List slots = resolver->availableSlots();
+    QCOMPARE(slots.size(), 2);
+    QCOMPARE(slots.at(0).start(), base);
+    QCOMPARE(slots.at(0).end(), meeting.start());
+    QCOMPARE(slots.at(1).start(), meeting.end());
+    QCOMPARE(slots.at(1).end(), end);
+
+    QVERIFY(!conflictsSpy.wait(100));
+}
+
+void ConflictResolverTest::testFindFreeSlot()
+{
+    // The attendees block each other in turns: the first free hour for everybody
+    // is only found after jumping back and forth between them.
+    const QDateTime start = base;
+    const auto hours = [&start](int from, int to) {
+        return KCalendarCore::Period(start.addSecs(from * 60 * 60), start.addSecs(to * 60 * 60));
+    };
+    addAttendee(u"kdabtest1@demo.kolab.org"_s,
+                KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << hours(5, 7) << hours(0, 2) << hours(1, 3))));
+    addAttendee(u"kdabtest2@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << hours(3, 5))));
+    addAttendee(u"kdabtest3@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << hours(7, 8))));
+    insertAttendees();
+
+    QVERIFY(resolver->findFreeSlot(hours(8, 9)));
+    QVERIFY(resolver->findFreeSlot(hours(0, 1)));
+
+    // busy for more than a year
+    addAttendee(u"kdabtest4@demo.kolab.org"_s,
+                KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << hours(-1, 400 * 24))));
+    insertAttendees();
+    QVERIFY(!resolver->findFreeSlot(hours(0, 1)));
+}
+
+void ConflictResolverTest::testSearchFreeSlotLimits()
+{
+    const QDateTime start = base;
+    const auto hours = [&start](int from, int to) {
+        return KCalendarCore::Period(start.addSecs(from * 60 * 60), start.addSecs(to * 60 * 60));
+    };
+    // busy for the next ten days, with a short break every day
+    KCalendarCore::Period::List busy;
+    for (int day = 0; day < 10; ++day) {
+        busy << hours(day * 24, day * 24 + 23);
+    }
+    addAttendee(u"kdabtest1@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(busy)));
+    addAttendee(u"kdabtest2@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << hours(0, 5 * 24))));
+    insertAttendees();
+
+    ConflictResolver::FreeSlotResult result = resolver->searchFreeSlot(hours(0, 2));
+    QCOMPARE(result.status, ConflictResolver::FreeSlotFound);
+    QCOMPARE(result.slot.start(), start.addSecs(239 * 60 * 60));
+    QCOMPARE(result.slot.end(), start.addSecs(241 * 60 * 60));
+
+    result = resolver->searchFreeSlot(hours(0, 1));
+    QCOMPARE(result.status, ConflictResolver::FreeSlotFound);
+    QCOMPARE(result.slot.start(), start.addSecs(143 * 60 * 60));
+
+    resolver->setSearchHorizon(3);
+    QCOMPARE(resolver->searchHorizon(), 3);
+    result = resolver->searchFreeSlot(hours(0, 1));
+    QCOMPARE(result.status, ConflictResolver::HorizonReached);
+    QVERIFY(!resolver->findFreeSlot(hours(0, 1)));
+
+    resolver->setSearchHorizon(365);
+    resolver->setMaxSearchSteps(3);
+    result = resolver->searchFreeSlot(hours(0, 1));
+    QCOMPARE(result.status, ConflictResolver::BudgetExhausted);
+
+    resolver->setMaxSearchSteps(0);
+    resolver->setMaxSearchTime(60 * 1000);
+    QCOMPARE(resolver->searchFreeSlot(hours(0, 1)).status, ConflictResolver::FreeSlotFound);
+}
+
+void ConflictResolverTest::testRankedSlots()
+{
+    base.setDate(QDate(2010, 7, 29));
+    base.setTime(QTime(8, 0));
+    end = base.addSecs(4 * 60 * 60);
+
+    KCalendarCore::FreeBusyPeriod tentative(_time(9, 0), _time(10, 0));
+    tentative.setType(KCalendarCore::FreeBusyPeriod::BusyTentative);
+    KCalendarCore::FreeBusyPeriod::List periods;
+    periods << KCalendarCore::FreeBusyPeriod(_time(8, 0), _time(9, 0)) << tentative;
+    addAttendee(u"kdabtest1@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(periods)));
+    addAttendee(u"kdabtest2@demo.kolab.org"_s,
+                KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << KCalendarCore::Period(_time(10, 0), _time(11, 0)))),
+                KCalendarCore::Attendee::OptParticipant);
+    addAttendee(u"kdabtest3@demo.kolab.org"_s,
+                KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << KCalendarCore::Period(_time(11, 0), _time(12, 0)))));
+    insertAttendees();
+
+    resolver->setMandatoryRoles({KCalendarCore::Attendee::ReqParticipant});
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+    resolver->setRankedSlotSearch(60 * 60, 3);
+    resolver->findAllFreeSlots();
+
+    // the optional attendee is busy from 10:00, the tentative period is cheaper
+    // than a busy one, and 09:15 overlaps both
+    const QList<ConflictResolver::RankedSlot> ranked = resolver->rankedSlots();
+    QCOMPARE(ranked.size(), 3);
+    QCOMPARE(ranked.at(0).period.start(), _time(10, 0));
+    QCOMPARE(ranked.at(0).period.end(), _time(11, 0));
+    QCOMPARE(ranked.at(0).penalty, qint64(10));
+    QCOMPARE(ranked.at(1).period.start(), _time(9, 0));
+    QCOMPARE(ranked.at(1).penalty, qint64(50));
+    QCOMPARE(ranked.at(2).period.start(), _time(9, 15));
+    QCOMPARE(ranked.at(2).penalty, qint64(60));
+
+    resolver->setRankedSlotSearch(0, 0);
+    QVERIFY(resolver->rankedSlots().isEmpty());
+}
+
+void ConflictResolverTest::testRecurringSlots()
+{
+    base.setDate(QDate(2010, 7, 29));
+    base.setTime(QTime(8, 0));
+    end = base.addSecs(4 * 60 * 60);
+
+    // busy in the first and in the third week
+    const QDateTime thirdWeek(base.date().addDays(14), QTime(10, 0));
+    addAttendee(u"kdabtest1@demo.kolab.org"_s,
+                KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List()
+                                                                         << KCalendarCore::Period(_time(9, 0), _time(10, 0))
+                                                                         << KCalendarCore::Period(thirdWeek, thirdWeek.addSecs(60 * 60)))));
+    insertAttendees();
+
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+    resolver->setResolution(15 * 60);
+
+    KCalendarCore::Recurrence recurrence;
+    recurrence.setStartDateTime(_time(9, 0), false);
+    recurrence.setWeekly(1);
+
+    QSignalSpy recurringSlotsAvailable(resolver, &ConflictResolver::recurringSlotsAvailable);
+    resolver->findRecurringSlots(recurrence, 60 * 60, 3);
+    QVERIFY(recurringSlotsAvailable.wait());
+    QCOMPARE(recurringSlotsAvailable.at(0).at(1).value<ConflictResolver::FreeSlotStatus>(), ConflictResolver::FreeSlotFound);
+    const auto slots = recurringSlotsAvailable.at(0).at(0).value<QList<ConflictResolver::RecurringSlot>>();
+    QCOMPARE(slots.size(), 13);
+    const auto conflictsAt = [&slots](const QDateTime &start) {
+        for (const ConflictResolver::RecurringSlot &slot : slots) {
+            if (slot.start == start) {
+                return slot.conflictingOccurrences;
+            }
+        }
+        return -1;
+    };
+    QCOMPARE(conflictsAt(_time(8, 0)), 0);
+    QCOMPARE(conflictsAt(_time(8, 15)), 1);
+    QCOMPARE(conflictsAt(_time(9, 0)), 1);
+    QCOMPARE(conflictsAt(_time(9, 15)), 2);
+    QCOMPARE(conflictsAt(_time(9, 45)), 2);
+    QCOMPARE(conflictsAt(_time(10, 0)), 1);
+    QCOMPARE(conflictsAt(_time(10, 45)), 1);
+    QCOMPARE(conflictsAt(_time(11, 0)), 0);
+
+    // a later search supersedes the running one
+    recurringSlotsAvailable.clear();
+    resolver->findRecurringSlots(recurrence, 60 * 60, 3);
+    resolver->findRecurringSlots(recurrence, 60 * 60, 0);
+    QVERIFY(recurringSlotsAvailable.wait());
+    QCOMPARE(recurringSlotsAvailable.count(), 1);
+    QVERIFY(recurringSlotsAvailable.at(0).at(0).value<QList<ConflictResolver::RecurringSlot>>().isEmpty());
+    QCOMPARE(recurringSlotsAvailable.at(0).at(1).value<ConflictResolver::FreeSlotStatus>(), ConflictResolver::HorizonReached);
+
+    // so do changes to the data
+    recurringSlotsAvailable.clear();
+    resolver->findRecurringSlots(recurrence, 60 * 60, 3);
+    resolver->freebusyDataChanged();
+    QVERIFY(!recurringSlotsAvailable.wait(500));
+
+    // one lookup per mandatory attendee and occurrence
+    resolver->setMaxSearchSteps(2);
+    resolver->findRecurringSlots(recurrence, 60 * 60, 3);
+    QVERIFY(recurringSlotsAvailable.wait());
+    QVERIFY(recurringSlotsAvailable.at(0).at(0).value<QList<ConflictResolver::RecurringSlot>>().isEmpty());
+    QCOMPARE(recurringSlotsAvailable.at(0).at(1).value<ConflictResolver::FreeSlotStatus>(), ConflictResolver::BudgetExhausted);
+}
+
+void ConflictResolverTest::testWorkingHours()
+{
+    const QDate day(2010, 7, 29); // a Thursday
+    const auto at = [day](int days, int h) {
+        return QDateTime(day.addDays(days), QTime(h, 0), QTimeZone::utc());
+    };
+    // both work from 9 to 5, the first one at UTC+2 and the second one at UTC-4
+    const KCalendarCore::Period::List lunch{{at(0, 13), at(0, 14)}};
+    addAttendee(u"kdabtest1@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(lunch)));
+    addAttendee(u"kdabtest2@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List{{at(-7, 0), at(-7, 1)}})));
+    insertAttendees();
+
+    ConflictResolver::WorkingHours east;
+    east.timeZone = QTimeZone::fromSecondsAheadOfUtc(2 * 60 * 60);
+    east.start = QTime(9, 0);
+    east.end = QTime(17, 0);
+    ConflictResolver::WorkingHours west = east;
+    west.timeZone = QTimeZone::fromSecondsAheadOfUtc(-4 * 60 * 60);
+    resolver->setWorkingHours(u"kdabtest1@demo.kolab.org"_s, east);
+    resolver->setWorkingHours(u"kdabtest2@demo.kolab.org"_s, west);
+    QCOMPARE(resolver->workingHours(u"kdabtest2@demo.kolab.org"_s), west);
+
+    resolver->setAllowedWeekdays(QBitArray(7, true));
+    resolver->setResolution(30 * 60);
+    resolver->setEarliestDateTime(at(0, 0));
+    resolver->setLatestDateTime(at(2, 0));
+
+    const auto verifyEngines = [this](const KCalendarCore::Period::List &expected) {
+        resolver->setFreeSlotEngine(ConflictResolver::BitmapEngine);
+        resolver->findAllFreeSlots();
+        QCOMPARE(resolver->availableSlots(), expected);
+        resolver->setFreeSlotEngine(ConflictResolver::SweepEngine);
+        resolver->findAllFreeSlots();
+        QCOMPARE(resolver->availableSlots(), expected);
+        resolver->setFreeSlotEngine(ConflictResolver::TiledEngine);
+        resolver->setTileSize(5);
+        resolver->findAllFreeSlots();
+        QCOMPARE(resolver->availableSlots(), expected);
+    };
+
+    // the working days overlap from 13:00 to 15:00 UTC
+    verifyEngines({{at(0, 14), at(0, 15)}, {at(1, 13), at(1, 15)}});
+
+    // the second one does not work on Fridays
+    west.workDays.clearBit(4);
+    resolver->setWorkingHours(u"kdabtest2@demo.kolab.org"_s, west);
+    verifyEngines({{at(0, 14), at(0, 15)}});
+
+    resolver->setWorkingHours(u"kdabtest1@demo.kolab.org"_s, {});
+    resolver->setWorkingHours(u"kdabtest2@demo.kolab.org"_s, {});
+    verifyEngines({{at(0, 0), at(0, 13)}, {at(0, 14), at(2, 0)}});
+}
+
+void ConflictResolverTest::testAttendeeRowsFollowModel()
+{
+    base.setDate(QDate(2010, 7, 29));
+    base.setTime(QTime(8, 0));
+    end = base.addSecs(4 * 60 * 60);
+
+    const KCalendarCore::Period meeting1(_time(9, 0), _time(10, 0));
+    const KCalendarCore::Period meeting2(_time(11, 0), _time(12, 0));
+    addAttendee(u"kdabtest1@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << meeting1)));
+    addAttendee(u"kdabtest2@demo.kolab.org"_s,
+                KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << meeting2)),
+                KCalendarCore::Attendee::OptParticipant);
+    insertAttendees();
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+
+    resolver->findAllFreeSlots();
+    QCOMPARE(resolver->availableSlots(), KCalendarCore::Period::List({{base, _time(9, 0)}, {_time(10, 0), _time(11, 0)}}));
+
+    // the role is taken from the row, not looked up again
+    resolver->setMandatoryRoles({KCalendarCore::Attendee::ReqParticipant});
+    resolver->findAllFreeSlots();
+    QCOMPARE(resolver->availableSlots(), KCalendarCore::Period::List({{base, _time(9, 0)}, {_time(10, 0), end}}));
+
+    resolver->removeAttendee(attendees.at(0)->attendee());
+    resolver->setMandatoryRoles({KCalendarCore::Attendee::ReqParticipant, KCalendarCore::Attendee::OptParticipant});
+    resolver->findAllFreeSlots();
+    QCOMPARE(resolver->availableSlots(), KCalendarCore::Period::List({{base, _time(11, 0)}}));
+
+    resolver->clearAttendees();
+    resolver->insertAttendee(attendees.at(0));
+    resolver->findAllFreeSlots();
+    QCOMPARE(resolver->availableSlots(), KCalendarCore::Period::List({{base, _time(9, 0)}, {_time(10, 0), end}}));
+}
+
+void ConflictResolverTest::testFreeBlocks()
+{
+    // 15 minute slots from 8:00 to 12:00
+    base.setDate(QDate(2010, 7, 29));
+    base.setTime(QTime(8, 0));
+    end = base.addSecs(4 * 60 * 60);
+    addAttendee(u"kdabtest1@demo.kolab.org"_s,
+                KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << KCalendarCore::Period(_time(9, 0), _time(10, 30)))));
+    insertAttendees();
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+    QVERIFY(!resolver->hasFreeBlock({base, end}, 60 * 60));
+    resolver->findAllFreeSlots();
+
+    QVERIFY(resolver->hasFreeBlock({base, end}, 90 * 60));
+    QVERIFY(!resolver->hasFreeBlock({base, end}, 91 * 60));
+    QVERIFY(resolver->hasFreeBlock({_time(7, 0), _time(9, 0)}, 60 * 60));
+    QVERIFY(!resolver->hasFreeBlock({_time(8, 10), _time(9, 10)}, 60 * 60));
+    QVERIFY(!resolver->hasFreeBlock({_time(9, 0), _time(10, 30)}, 15 * 60));
+    QCOMPARE(resolver->busyFractions(60 * 60), QList<qreal>({0.0, 1.0, 0.5, 0.0}));
+    QCOMPARE(resolver->busyFractions(3 * 60 * 60), QList<qreal>({0.5, 0.0}));
+}
+
+void ConflictResolverTest::testProgressiveSearch()
+{
+    base.setDate(QDate(2010, 7, 29));
+    base.setTime(QTime(8, 0));
+    end = base.addDays(21);
+
+    // lunch every day, three weeks long
+    KCalendarCore::Period::List lunches;
+    for (int day = 0; day < 21; ++day) {
+        const QDateTime lunch(base.date().addDays(day), QTime(12, 0));
+        lunches << KCalendarCore::Period(lunch, lunch.addSecs(60 * 60));
+    }
+    addAttendee(u"kdabtest1@demo.kolab.org"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(lunches)));
+    insertAttendees();
+
+    QSignalSpy batchSpy(resolver, &ConflictResolver::freeSlotsBatchAvailable);
+    QSignalSpy slotsSpy(resolver, &ConflictResolver::freeSlotsAvailable);
+    resolver->setResolution(60 * 60);
+    resolver->setProgressiveSearch(7 * 24 * 60 * 60);
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+    QVERIFY(slotsSpy.wait());
+
+    // the batches arrive in order and add up to the complete list
+    QVERIFY(batchSpy.count() >= 3);
+    KCalendarCore::Period::List streamed;
+    for (const QList<QVariant> &batch : std::as_const(batchSpy)) {
+        QCOMPARE(batch.at(0).toInt(), streamed.size());
+        streamed += batch.at(1).value<KCalendarCore::Period::List>();
+    }
+    QCOMPARE(resolver->availableSlots().size(), 22);
+    QCOMPARE(streamed, resolver->availableSlots());
+
+    // without progressive mode there are no batches
+    batchSpy.clear();
+    resolver->setProgressiveSearch(0);
+    resolver->freebusyDataChanged();
+    QVERIFY(slotsSpy.wait());
+    QCOMPARE(batchSpy.count(), 0);
+}
+
+void ConflictResolverTest::testCachedFreeBusy()
+{
+    FreeBusyCache *cache = FreeBusyCache::self();
+    const QString previousDirectory = cache->cacheDirectory();
+    cache->setCacheDirectory(QString());
+    cache->clear();
+    const QString email = u"cached@example.com"_s;
+    KCalendarCore::FreeBusy::Ptr const fb(new KCalendarCore::FreeBusy(base, end));
+    fb->addPeriod(base.addSecs(60 * 60), base.addSecs(2 * 60 * 60));
+    cache->insert(email, fb);
+
+    // a resolver's rows start out with the cached list
+    resolver->insertAttendee(KCalendarCore::Attendee(u"cached"_s, email));
+    const QModelIndex index = resolver->model()->index(0, 0);
+    QCOMPARE(resolver->model()->data(index, CalendarSupport::FreeBusyItemModel::FreeBusyRole).value<KCalendarCore::FreeBusy::Ptr>(), fb);
+
+    cache->setCacheDirectory(previousDirectory);
+    cache->clear();
+}
+
+void ConflictResolverTest::testDebouncedRecalculation()
+{
+    KCalendarCore::Period const meeting(base.addSecs(2 * 60 * 60), KCalendarCore::Duration(60 * 60));
+    addAttendee(u"albert@einstein.net"_s, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(KCalendarCore::Period::List() << meeting)));
+    insertAttendees();
+    resolver->setResolution(15 * 60);
+    resolver->setEarliestDateTime(base);
+    resolver->setLatestDateTime(end);
+    QSignalSpy conflictsDetected(resolver, &ConflictResolver::conflictsDetected);
+    QVERIFY(conflictsDetected.wait());
+
+    // a burst of changes spread over several event loop passes leads to one calculation
+    conflictsDetected.clear();
+    resolver->setRecalculationDelay(300);
+    resolver->setEarliestDate(base.date().addDays(-1));
+    QTest::qWait(50);
+    resolver->setEarliestTime(QTime(8, 0));
+    resolver->setLatestDate(end.date().addDays(1));
+    QTest::qWait(50);
+    resolver->setLatestTime(QTime(18, 0));
+    resolver->setAllowedWeekdays(QBitArray(7, false));
+    QCOMPARE(conflictsDetected.count(), 0);
+    QVERIFY(conflictsDetected.wait());
+    QTest::qWait(400);
+    QCOMPARE(conflictsDetected.count(), 1);
+
+    // changes which do not change anything do not calculate again
+    conflictsDetected.clear();
+    resolver->setLatestTime(QTime(18, 0));
+    resolver->setAllowedWeekdays(QBitArray(7, false));
+    resolver->setMandatoryRoles(
+        {KCalendarCore::Attendee::ReqParticipant, KCalendarCore::Attendee::OptParticipant, KCalendarCore::Attendee::NonParticipant, KCalendarCore::Attendee::Chair});
+    QVERIFY(!conflictsDetected.wait(500));
+}
+
 QTEST_MAIN(ConflictResolverTest)
 
 #include "moc_conflictresolvertest.cpp"
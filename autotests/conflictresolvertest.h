@@ -33,6 +33,21 @@ private Q_SLOTS:
     void testPeriodEndsAfterTimeframeEnds();
     void testPeriodIsLargerThenTimeframe();
     void testPeriodEndsAtSametimeAsTimeframe();
+    void testFreeSlotsAcrossWordBoundaries();
+    void testEnginesAgree_data();
+    void testEnginesAgree();
+    void testCachedRowsFollowChanges();
+    void testLatestCalculationWins();
+    void testFindFreeSlot();
+    void testSearchFreeSlotLimits();
+    void testRankedSlots();
+    void testRecurringSlots();
+    void testWorkingHours();
+    void testAttendeeRowsFollowModel();
+    void testFreeBlocks();
+    void testProgressiveSearch();
+    void testCachedFreeBusy();
+    void testDebouncedRecalculation();
 
 private:
     void insertAttendees();
@@ -0,0 +1,81 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "contactgroupschedulertest.h"
+#include "contactgroupscheduler.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+QTEST_GUILESS_MAIN(ContactGroupSchedulerTest)
+
+using namespace IncidenceEditorNG;
+using namespace Qt::Literals::StringLiterals;
+
+void ContactGroupSchedulerTest::cleanup()
+{
+    ContactGroupScheduler::self()->clear();
+    ContactGroupScheduler::self()->setTimeToLive(ContactGroupScheduler::DefaultTimeToLive);
+}
+
+void ContactGroupSchedulerTest::testBatchedResults()
+{
+    ContactGroupScheduler *scheduler = ContactGroupScheduler::self();
+    const KContacts::ContactGroup team(u"Team"_s);
+    scheduler->insertGroups(u"Team"_s, {team});
+    scheduler->insertGroups(u"jane@example.com"_s, {});
+    KContacts::Addressee jane;
+    jane.setName(u"Jane"_s);
+    jane.addEmail(KContacts::Email(u"jane@example.com"_s));
+    scheduler->insertMembers(ContactGroupScheduler::groupKey(team), {jane});
+
+    QSignalSpy found(scheduler, &ContactGroupScheduler::groupsFound);
+    QSignalSpy expanded(scheduler, &ContactGroupScheduler::groupsExpanded);
+
+    // cached results need no job and are still reported later, all at once
+    scheduler->findGroups(u"Team"_s);
+    scheduler->findGroups(u"jane@example.com"_s);
+    scheduler->findGroups(u"Team"_s);
+    scheduler->findGroups(QString());
+    scheduler->expandGroup(team);
+    QCOMPARE(scheduler->runningJobs(), 0);
+    QCOMPARE(scheduler->queuedJobs(), 0);
+    QCOMPARE(found.count(), 0);
+
+    QVERIFY(found.wait());
+    QCOMPARE(found.count(), 1);
+    const auto groups = found.at(0).at(0).value<QHash<QString, KContacts::ContactGroup::List>>();
+    QCOMPARE(groups.size(), 2);
+    QCOMPARE(groups.value(u"Team"_s).size(), 1);
+    QCOMPARE(groups.value(u"Team"_s).first().name(), u"Team"_s);
+    QVERIFY(groups.contains(u"jane@example.com"_s));
+    QVERIFY(groups.value(u"jane@example.com"_s).isEmpty());
+
+    QCOMPARE(expanded.count(), 1);
+    const auto members = expanded.at(0).at(0).value<QHash<QString, KContacts::Addressee::List>>();
+    QCOMPARE(members.size(), 1);
+    QCOMPARE(members.value(ContactGroupScheduler::groupKey(team)).size(), 1);
+    QCOMPARE(members.value(ContactGroupScheduler::groupKey(team)).first().preferredEmail(), u"jane@example.com"_s);
+
+    // nothing new, nothing reported
+    QVERIFY(!found.wait(100));
+    QCOMPARE(found.count(), 1);
+    QCOMPARE(expanded.count(), 1);
+}
+
+void ContactGroupSchedulerTest::testGroupKey()
+{
+    KContacts::ContactGroup group(u"Team"_s);
+    group.setId(QString());
+    QCOMPARE(ContactGroupScheduler::groupKey(group), u"Team"_s);
+    group.setId(u"1234"_s);
+    QCOMPARE(ContactGroupScheduler::groupKey(group), u"1234"_s);
+
+    ContactGroupScheduler *scheduler = ContactGroupScheduler::self();
+    scheduler->setMaximumJobs(0);
+    QCOMPARE(scheduler->maximumJobs(), 1);
+    scheduler->setMaximumJobs(ContactGroupScheduler::DefaultMaximumJobs);
+}
@@ -0,0 +1,174 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "freebusycachetest.h"
+#include "freebusycache.h"
+
+#include <KCalendarCore/Attendee>
+#include <KCalendarCore/FreeBusy>
+#include <KCalendarCore/FreeBusyPeriod>
+#include <KCalendarCore/Period>
+
+#include <QDir>
+#include <QFile>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+
+QTEST_MAIN(FreeBusyCacheTest)
+
+using namespace IncidenceEditorNG;
+using namespace Qt::Literals::StringLiterals;
+
+void FreeBusyCacheTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void FreeBusyCacheTest::init()
+{
+    base = QDateTime::currentDateTime().addDays(1);
+    end = base.addSecs(10 * 60 * 60);
+
+    // in memory only, unless a test asks for a directory
+    FreeBusyCache *cache = FreeBusyCache::self();
+    previousDirectory = cache->cacheDirectory();
+    cache->setCacheDirectory(QString());
+    cache->clear();
+}
+
+void FreeBusyCacheTest::cleanup()
+{
+    FreeBusyCache *cache = FreeBusyCache::self();
+    cache->setTimeToLive(FreeBusyCache::DefaultTimeToLive);
+    cache->setCacheDirectory(previousDirectory);
+    cache->clear();
+}
+
+void FreeBusyCacheTest::testSharedLists()
+{
+    FreeBusyCache *cache = FreeBusyCache::self();
+    const QString email = u"cached@example.com"_s;
+    QVERIFY(!cache->freeBusy(email));
+
+    KCalendarCore::FreeBusy::Ptr const fb(new KCalendarCore::FreeBusy(base, end));
+    fb->addPeriod(base.addSecs(60 * 60), base.addSecs(2 * 60 * 60));
+    cache->insert(email, fb);
+
+    // everybody gets the same list, as long as it covers what they ask for
+    QCOMPARE(cache->freeBusy(email), fb);
+    QCOMPARE(cache->freeBusy(u"Cached@Example.com"_s), fb);
+    QCOMPARE(cache->freeBusy(email, KCalendarCore::Period(base, end)), fb);
+    QVERIFY(!cache->freeBusy(email, KCalendarCore::Period(base, end.addDays(1))));
+    QVERIFY(cache->retrieve(email));
+}
+
+void FreeBusyCacheTest::testCreateItem()
+{
+    FreeBusyCache *cache = FreeBusyCache::self();
+    const QString email = u"cached@example.com"_s;
+    KCalendarCore::FreeBusy::Ptr const fb(new KCalendarCore::FreeBusy(base, end));
+    cache->insert(email, fb);
+
+    // a cached list is handed out right away, and keeps the model from fetching it again
+    const KCalendarCore::Attendee attendee(u"cached"_s, email);
+    const CalendarSupport::FreeBusyItem::Ptr item = cache->createItem(attendee, KCalendarCore::Period(base, end));
+    QCOMPARE(item->freeBusy(), fb);
+    QVERIFY(item->isDownloading());
+}
+
+void FreeBusyCacheTest::testTimeToLive()
+{
+    FreeBusyCache *cache = FreeBusyCache::self();
+    const QString email = u"cached@example.com"_s;
+    cache->insert(email, KCalendarCore::FreeBusy::Ptr(new KCalendarCore::FreeBusy(base, end)));
+    QVERIFY(cache->freeBusy(email));
+
+    cache->setTimeToLive(0);
+    QCOMPARE(cache->timeToLive(), 0);
+    QTRY_VERIFY(!cache->freeBusy(email));
+}
+
+KCalendarCore::FreeBusy::Ptr FreeBusyCacheTest::busyList() const
+{
+    // unsorted, the tentative period last
+    KCalendarCore::FreeBusy::Ptr const fb(new KCalendarCore::FreeBusy(base, end));
+    fb->addPeriod(base.addSecs(3 * 60 * 60), base.addSecs(4 * 60 * 60));
+    fb->addPeriod(base.addSecs(60 * 60), base.addSecs(2 * 60 * 60));
+    KCalendarCore::FreeBusyPeriod tentative(base.addSecs(5 * 60 * 60), base.addSecs(6 * 60 * 60));
+    tentative.setType(KCalendarCore::FreeBusyPeriod::BusyTentative);
+    fb->addPeriods(KCalendarCore::FreeBusyPeriod::List{tentative});
+    return fb;
+}
+
+void FreeBusyCacheTest::testDiskCache()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    FreeBusyCache *cache = FreeBusyCache::self();
+    cache->setCacheDirectory(directory.path());
+
+    const QString email = u"stored@example.com"_s;
+    const KCalendarCore::FreeBusy::Ptr fb = busyList();
+    cache->insert(email, fb);
+
+    // after a restart the list comes back from the disk, sorted, and still counts as fresh
+    cache->clear();
+    const KCalendarCore::FreeBusy::Ptr stored = cache->freeBusy(email, KCalendarCore::Period(base, end));
+    QVERIFY(stored);
+    QVERIFY(stored != fb);
+    QCOMPARE(stored->dtStart().toSecsSinceEpoch(), base.toSecsSinceEpoch());
+    QCOMPARE(stored->dtEnd().toSecsSinceEpoch(), end.toSecsSinceEpoch());
+    const KCalendarCore::FreeBusyPeriod::List periods = stored->fullBusyPeriods();
+    QCOMPARE(periods.size(), 3);
+    QCOMPARE(periods.at(0).start().toSecsSinceEpoch(), base.addSecs(60 * 60).toSecsSinceEpoch());
+    QCOMPARE(periods.at(1).end().toSecsSinceEpoch(), base.addSecs(4 * 60 * 60).toSecsSinceEpoch());
+    QCOMPARE(periods.at(2).type(), KCalendarCore::FreeBusyPeriod::BusyTentative);
+
+    // an old list is still shown, but no longer counts as fresh
+    cache->clear();
+    cache->setTimeToLive(0);
+    QTRY_VERIFY(!cache->freeBusy(email));
+    QCOMPARE(cache->lastKnownFreeBusy(email)->fullBusyPeriods().size(), 3);
+    QVERIFY(!cache->lastKnownFreeBusy(u"unknown@example.com"_s));
+}
+
+void FreeBusyCacheTest::testBrokenFiles_data()
+{
+    QTest::addColumn<bool>("truncate");
+
+    QTest::newRow("truncated") << true;
+    QTest::newRow("invalid type") << false;
+}
+
+void FreeBusyCacheTest::testBrokenFiles()
+{
+    QFETCH(bool, truncate);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    FreeBusyCache *cache = FreeBusyCache::self();
+    cache->setCacheDirectory(directory.path());
+    const QString email = u"stored@example.com"_s;
+    cache->insert(email, busyList());
+    cache->clear();
+    QVERIFY(cache->lastKnownFreeBusy(email));
+
+    // the last byte is the type of the last period, the largest valid one is Unknown
+    cache->clear();
+    const QStringList files = QDir(directory.path()).entryList(QDir::Files);
+    QCOMPARE(files.size(), 1);
+    QFile file(directory.filePath(files.first()));
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    if (truncate) {
+        QVERIFY(file.resize(file.size() - 1));
+    } else {
+        QVERIFY(file.seek(file.size() - 1));
+        QVERIFY(file.putChar(char(KCalendarCore::FreeBusyPeriod::Unknown + 1)));
+    }
+    file.close();
+    QVERIFY(!cache->lastKnownFreeBusy(email));
+}
@@ -0,0 +1,33 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <KCalendarCore/FreeBusy>
+
+#include <QDateTime>
+#include <QObject>
+
+class FreeBusyCacheTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void testSharedLists();
+    void testCreateItem();
+    void testTimeToLive();
+    void testDiskCache();
+    void testBrokenFiles_data();
+    void testBrokenFiles();
+
+private:
+    [[nodiscard]] KCalendarCore::FreeBusy::Ptr busyList() const;
+
+    QDateTime base, end;
+    QString previousDirectory;
+};
@@ -0,0 +1,77 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "freebusypyramidtest.h"
+#include "freebusybitmap.h"
+#include "freebusypyramid.h"
+
+#include <QTest>
+
+QTEST_GUILESS_MAIN(FreeBusyPyramidTest)
+
+using namespace IncidenceEditorNG;
+
+void FreeBusyPyramidTest::testQueries()
+{
+    // 100 slots, busy: [3, 10), [40, 41), [70, 100)
+    FreeBusyBitmap busy(100);
+    busy.fill(3, 10);
+    busy.setBit(40);
+    busy.fill(70, 100);
+    const FreeBusyPyramid pyramid(busy);
+    QCOMPARE(pyramid.size(), 100);
+    QCOMPARE(pyramid.busyCount(0, 100), 38);
+    QCOMPARE(pyramid.busyCount(5, 41), 6);
+    QCOMPARE(pyramid.longestFreeRun(0, 100), 30);
+    QCOMPARE(pyramid.longestFreeRun(0, 40), 30);
+    QCOMPARE(pyramid.longestFreeRun(0, 39), 29);
+    QCOMPARE(pyramid.longestFreeRun(35, 60), 19);
+    QCOMPARE(pyramid.longestFreeRun(70, 100), 0);
+    QCOMPARE(pyramid.longestFreeRun(0, 3), 3);
+    QCOMPARE(pyramid.busyCounts(25), QList<int>({7, 1, 5, 25}));
+    QCOMPARE(pyramid.busyCounts(40), QList<int>({7, 11, 20}));
+}
+
+void FreeBusyPyramidTest::testFreeRuns()
+{
+    // the same row as a few free runs, queries inside one stretch and across many agree
+    const FreeBusyPyramid pyramid(100, {{0, 3}, {10, 30}, {41, 29}});
+    QCOMPARE(pyramid.size(), 100);
+    QCOMPARE(pyramid.busyCount(0, 100), 38);
+    QCOMPARE(pyramid.busyCount(4, 6), 2);
+    QCOMPARE(pyramid.busyCount(5, 41), 6);
+    QCOMPARE(pyramid.longestFreeRun(12, 20), 8);
+    QCOMPARE(pyramid.longestFreeRun(35, 60), 19);
+    QCOMPARE(pyramid.longestFreeRun(-10, 200), 30);
+    QCOMPARE(pyramid.busyCounts(25), QList<int>({7, 1, 5, 25}));
+
+    // a year at one minute resolution with a meeting every day, free runs touch at midnight
+    QList<FreeBusyBitmap::Run> freeRuns;
+    const int day = 24 * 60;
+    for (int first = 0; first < 365 * day; first += day) {
+        freeRuns.append({first, 10 * 60});
+        freeRuns.append({first + 11 * 60, day - 11 * 60});
+    }
+    const FreeBusyPyramid year(365 * day, freeRuns);
+    QCOMPARE(year.busyCount(0, 365 * day), 365 * 60);
+    QCOMPARE(year.longestFreeRun(0, 365 * day), day - 60);
+    QCOMPARE(year.longestFreeRun(10 * 60 + 30, 11 * 60 + 30), 30);
+    QCOMPARE(year.busyCounts(7 * day).constFirst(), 7 * 60);
+}
+
+void FreeBusyPyramidTest::testEmpty()
+{
+    const FreeBusyPyramid empty;
+    QCOMPARE(empty.size(), 0);
+    QCOMPARE(empty.busyCount(0, 10), 0);
+    QCOMPARE(empty.longestFreeRun(0, 10), 0);
+    QVERIFY(empty.busyCounts(10).isEmpty());
+
+    // nothing free at all
+    const FreeBusyPyramid busy(10, {});
+    QCOMPARE(busy.busyCount(0, 10), 10);
+    QCOMPARE(busy.longestFreeRun(0, 10), 0);
+}
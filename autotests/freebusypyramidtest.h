@@ -0,0 +1,18 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+class FreeBusyPyramidTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testQueries();
+    void testFreeRuns();
+    void testEmpty();
+};
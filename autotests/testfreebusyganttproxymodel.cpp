@@ -15,6 +15,7 @@
 #include <KGanttGraphicsView>
 
 #include <QAbstractItemModelTester>
+#include <QLocale>
 #include <QStandardPaths>
 #include <QTest>
 #include <QTimeZone>
@@ -105,4 +106,88 @@ void FreeBusyGanttProxyModelTest::testModelValidity()
     delete modelTest;
 }
 
+void FreeBusyGanttProxyModelTest::testLevelOfDetail()
+{
+    CalendarSupport::FreeBusyItemModel fbModel;
+    FreeBusyGanttProxyModel ganttModel;
+    ganttModel.setSourceModel(&fbModel);
+    QAbstractItemModelTester modelTest(&ganttModel);
+
+    const QDate day(2010, 8, 24);
+    const auto at = [day](int dayOffset, int hour, int minute = 0) {
+        return QDateTime(day.addDays(dayOffset), QTime(hour, minute), QTimeZone::utc());
+    };
+    KCalendarCore::FreeBusy::Ptr const fb(new KCalendarCore::FreeBusy());
+    fb->addPeriod(at(0, 7), at(0, 8));
+    fb->addPeriod(at(0, 7, 30), at(0, 9)); // overlaps the one before
+    fb->addPeriod(at(0, 9), at(0, 10)); // touches the one before
+    fb->addPeriod(at(0, 12), at(0, 13));
+    fb->addPeriod(at(1, 7), at(1, 8));
+    CalendarSupport::FreeBusyItem::Ptr const item(new CalendarSupport::FreeBusyItem(KCalendarCore::Attendee(u"fred"_s, u"fred@example.com"_s), nullptr));
+    item->setFreeBusy(fb);
+    fbModel.addItem(item);
+
+    const QModelIndex attendee = ganttModel.index(0, 0);
+    QCOMPARE(ganttModel.rowCount(attendee), 5);
+    QCOMPARE(ganttModel.index(0, 0, attendee).data(KGantt::EndTimeRole).toDateTime(), at(0, 8));
+
+    // the cached times and tooltips follow the switch to merged periods
+    ganttModel.setMergePeriods(true);
+    QCOMPARE(ganttModel.rowCount(attendee), 3);
+    const QModelIndex merged = ganttModel.index(0, 0, attendee);
+    QCOMPARE(merged.data(KGantt::StartTimeRole).toDateTime(), at(0, 7));
+    QCOMPARE(merged.data(KGantt::EndTimeRole).toDateTime(), at(0, 10));
+    const QString toolTip = merged.data(Qt::ToolTipRole).toString();
+    QVERIFY(toolTip.contains(QLocale().toString(at(0, 10).toLocalTime(), QLocale::ShortFormat)));
+    QCOMPARE(merged.data(Qt::ToolTipRole).toString(), toolTip);
+    QCOMPARE(ganttModel.index(1, 0, attendee).data(KGantt::EndTimeRole).toDateTime(), at(0, 13));
+
+    // only what intersects the visible range is exposed
+    ganttModel.setVisibleRange(at(0, 11), at(0, 23));
+    QCOMPARE(ganttModel.rowCount(attendee), 1);
+    QCOMPARE(ganttModel.index(0, 0, attendee).data(KGantt::StartTimeRole).toDateTime(), at(0, 12));
+    ganttModel.setVisibleRange(at(0, 8, 30), at(0, 11));
+    QCOMPARE(ganttModel.rowCount(attendee), 1);
+    QCOMPARE(ganttModel.index(0, 0, attendee).data(KGantt::StartTimeRole).toDateTime(), at(0, 7));
+
+    ganttModel.setMergePeriods(false);
+    QCOMPARE(ganttModel.rowCount(attendee), 2);
+    ganttModel.setVisibleRange({}, {});
+    QCOMPARE(ganttModel.rowCount(attendee), 5);
+}
+
+void FreeBusyGanttProxyModelTest::testVisibleRows()
+{
+    CalendarSupport::FreeBusyItemModel fbModel;
+    FreeBusyGanttProxyModel ganttModel;
+    ganttModel.setSourceModel(&fbModel);
+    QAbstractItemModelTester modelTest(&ganttModel);
+
+    const QDateTime start(QDate(2010, 8, 24), QTime(7, 0, 0), QTimeZone::utc());
+    for (int i = 0; i < 5; ++i) {
+        KCalendarCore::FreeBusy::Ptr const fb(new KCalendarCore::FreeBusy());
+        fb->addPeriod(start.addSecs(i * 60 * 60), KCalendarCore::Duration(30 * 60));
+        fb->addPeriod(start.addDays(1), KCalendarCore::Duration(30 * 60));
+        CalendarSupport::FreeBusyItem::Ptr const item(
+            new CalendarSupport::FreeBusyItem(KCalendarCore::Attendee(u"room %1"_s.arg(i), u"room%1@example.com"_s.arg(i)), nullptr));
+        item->setFreeBusy(fb);
+        fbModel.addItem(item);
+    }
+
+    // attendees out of view stay, without their periods
+    ganttModel.setVisibleRows(1, 2);
+    QCOMPARE(ganttModel.rowCount(), 5);
+    QCOMPARE(ganttModel.rowCount(ganttModel.index(0, 0)), 0);
+    QCOMPARE(ganttModel.rowCount(ganttModel.index(1, 0)), 2);
+    QCOMPARE(ganttModel.rowCount(ganttModel.index(2, 0)), 2);
+    QCOMPARE(ganttModel.rowCount(ganttModel.index(3, 0)), 0);
+    QCOMPARE(ganttModel.index(0, 0, ganttModel.index(2, 0)).data(KGantt::StartTimeRole).toDateTime(), start.addSecs(2 * 60 * 60));
+
+    ganttModel.setVisibleRows(-1, -1);
+    QCOMPARE(ganttModel.firstVisibleRow(), -1);
+    for (int i = 0; i < 5; ++i) {
+        QCOMPARE(ganttModel.rowCount(ganttModel.index(i, 0)), 2);
+    }
+}
+
 #include "moc_testfreebusyganttproxymodel.cpp"
@@ -14,4 +14,6 @@ class FreeBusyGanttProxyModelTest : public QObject
 private Q_SLOTS:
     void initTestCase();
     void testModelValidity();
+    void testLevelOfDetail();
+    void testVisibleRows();
 };
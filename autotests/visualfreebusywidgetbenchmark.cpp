@@ -0,0 +1,88 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "visualfreebusywidgetbenchmark.h"
+#include "visualfreebusywidget.h"
+
+#include <CalendarSupport/FreeBusyItem>
+#include <CalendarSupport/FreeBusyItemModel>
+
+#include <KCalendarCore/Attendee>
+#include <KCalendarCore/FreeBusy>
+
+#include <KGanttGraphicsView>
+
+#include <QComboBox>
+#include <QRandomGenerator>
+#include <QScrollBar>
+#include <QStandardPaths>
+#include <QTest>
+
+using namespace IncidenceEditorNG;
+using namespace Qt::Literals::StringLiterals;
+
+void VisualFreeBusyWidgetBenchmark::scroll_data()
+{
+    QTest::addColumn<int>("attendees");
+    QTest::addColumn<int>("periods");
+    QTest::addColumn<int>("scale"); // the index in the scale combo box
+
+    const QList<int> periodCounts{10, 100};
+    for (int periods : periodCounts) {
+        QTest::newRow(qPrintable(u"1000 attendees, %1 periods, hour scale"_s.arg(periods))) << 1000 << periods << 0;
+        QTest::newRow(qPrintable(u"1000 attendees, %1 periods, week scale"_s.arg(periods))) << 1000 << periods << 2;
+    }
+}
+
+void VisualFreeBusyWidgetBenchmark::scroll()
+{
+    QFETCH(int, attendees);
+    QFETCH(int, periods);
+    QFETCH(int, scale);
+    QStandardPaths::setTestModeEnabled(true);
+
+    // one hour meetings spread over the 30 days the chart shows, seeded, so
+    // every run sees the same data
+    QRandomGenerator random(quint32(attendees) * 1000 + quint32(periods));
+    const QDateTime start = QDateTime::currentDateTime().addDays(-15);
+    CalendarSupport::FreeBusyItemModel model;
+    for (int i = 0; i < attendees; ++i) {
+        KCalendarCore::FreeBusy::Ptr const fb(new KCalendarCore::FreeBusy());
+        for (int period = 0; period < periods; ++period) {
+            fb->addPeriod(start.addSecs(qint64(random.bounded(30 * 24)) * 60 * 60), KCalendarCore::Duration(60 * 60));
+        }
+        CalendarSupport::FreeBusyItem::Ptr const item(
+            new CalendarSupport::FreeBusyItem(KCalendarCore::Attendee(u"room %1"_s.arg(i), u"room%1@example.com"_s.arg(i)), nullptr));
+        item->setFreeBusy(fb);
+        model.addItem(item);
+    }
+
+    VisualFreeBusyWidget widget(&model);
+    widget.resize(1200, 800);
+    widget.show();
+    QVERIFY(QTest::qWaitForWindowExposed(&widget));
+
+    auto scaleCombo = widget.findChild<QComboBox *>();
+    QVERIFY(scaleCombo);
+    scaleCombo->setCurrentIndex(scale);
+    Q_EMIT scaleCombo->activated(scale);
+
+    auto view = widget.findChild<KGantt::GraphicsView *>(u"mGanttGraphicsView"_s);
+    QVERIFY(view);
+    QScrollBar *scrollBar = view->verticalScrollBar();
+    QCoreApplication::processEvents();
+
+    QBENCHMARK {
+        const int next = scrollBar->value() + scrollBar->pageStep();
+        scrollBar->setValue(next > scrollBar->maximum() ? 0 : next);
+        QCoreApplication::processEvents();
+        view->viewport()->repaint();
+    }
+}
+
+QTEST_MAIN(VisualFreeBusyWidgetBenchmark)
+
+#include "moc_visualfreebusywidgetbenchmark.cpp"
@@ -0,0 +1,24 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QObject>
+
+/*
+ * Benchmarks scrolling through the free/busy gantt chart of 1000 attendees,
+ * one frame per iteration: scrolling a page down and painting the view.
+ *
+ * Not run by ctest. To compare runs, let QTest write the results as CSV:
+ *   visualfreebusywidgetbenchmark -o results.csv,csv
+ */
+class VisualFreeBusyWidgetBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void scroll_data();
+    void scroll();
+};
@@ -10,6 +10,8 @@
 
 #include <KLocalizedString>
 
+#include <algorithm>
+
 using namespace IncidenceEditorNG;
 
 AttendeeTableModel::AttendeeTableModel(QObject *parent)
@@ -49,7 +51,7 @@ QVariant AttendeeTableModel::data(const QModelIndex &index, int role) const
         return {};
     }
 
-    const KCalendarCore::Attendee attendee = mAttendeeList[index.row()];
+    const KCalendarCore::Attendee &attendee = mAttendeeList.at(index.row());
     if (role == Qt::DisplayRole || role == Qt::EditRole) {
         switch (index.column()) {
         case Role:
@@ -127,6 +129,7 @@ bool AttendeeTableModel::setData(const QModelIndex &index, const QVariant &value
             break;
         case CuType:
             attendee.setCuType(static_cast<KCalendarCore::Attendee::CuType>(value.toInt()));
+            mResources[index.row()] = isResourceType(attendee.cuType());
             break;
         case Response:
             attendee.setRSVP(value.toBool());
@@ -181,6 +184,7 @@ bool AttendeeTableModel::insertRows(int position, int rows, const QModelIndex &p
         mAttendeeList.insert(position, attendee);
         mAttendeeAvailable.insert(mAttendeeAvailable.begin() + position, AvailableStatus{});
     }
+    mResources.insert(mResources.begin() + position, rows, false);
 
     endInsertRows();
     return true;
@@ -194,6 +198,7 @@ bool AttendeeTableModel::removeRows(int position, int rows, const QModelIndex &p
         mAttendeeAvailable.erase(mAttendeeAvailable.begin() + position);
         mAttendeeList.remove(position);
     }
+    mResources.erase(mResources.begin() + position, mResources.begin() + position + rows);
 
     endRemoveRows();
     return true;
@@ -201,9 +206,23 @@ bool AttendeeTableModel::removeRows(int position, int rows, const QModelIndex &p
 
 bool AttendeeTableModel::insertAttendee(int position, const KCalendarCore::Attendee &attendee)
 {
-    beginInsertRows(QModelIndex(), position, position);
-    mAttendeeList.insert(position, attendee);
-    mAttendeeAvailable.insert(mAttendeeAvailable.begin() + position, AvailableStatus{});
+    return insertAttendees(position, {attendee});
+}
+
+bool AttendeeTableModel::insertAttendees(int position, const KCalendarCore::Attendee::List &attendees)
+{
+    if (attendees.isEmpty()) {
+        return true;
+    }
+
+    beginInsertRows(QModelIndex(), position, position + attendees.size() - 1);
+    mAttendeeList.insert(position, attendees.size(), KCalendarCore::Attendee());
+    std::copy(attendees.cbegin(), attendees.cend(), mAttendeeList.begin() + position);
+    mAttendeeAvailable.insert(mAttendeeAvailable.begin() + position, attendees.size(), AvailableStatus{});
+    mResources.insert(mResources.begin() + position, attendees.size(), false);
+    std::transform(attendees.cbegin(), attendees.cend(), mResources.begin() + position, [](const KCalendarCore::Attendee &attendee) {
+        return isResourceType(attendee.cuType());
+    });
     endInsertRows();
 
     addEmptyAttendee();
@@ -211,6 +230,47 @@ bool AttendeeTableModel::insertAttendee(int position, const KCalendarCore::Atten
     return true;
 }
 
+void AttendeeTableModel::replaceAttendees(const QMap<int, KCalendarCore::Attendee::List> &replacements)
+{
+    if (replacements.isEmpty()) {
+        return;
+    }
+
+    beginResetModel();
+
+    // one pass over the rows, the rows kept keep their availability
+    KCalendarCore::Attendee::List attendees;
+    std::vector<AvailableStatus> available;
+    attendees.reserve(mAttendeeList.size());
+    available.reserve(mAttendeeList.size());
+    int next = 0;
+    for (auto it = replacements.cbegin(), end = replacements.cend(); it != end; ++it) {
+        const int row = it.key();
+        if (row < next || row >= mAttendeeList.size()) {
+            continue;
+        }
+        attendees.append(mAttendeeList.mid(next, row - next));
+        available.insert(available.end(), mAttendeeAvailable.begin() + next, mAttendeeAvailable.begin() + row);
+        attendees.append(it.value());
+        available.resize(available.size() + it.value().size(), AvailableStatus{});
+        next = row + 1;
+    }
+    attendees.append(mAttendeeList.mid(next));
+    available.insert(available.end(), mAttendeeAvailable.begin() + next, mAttendeeAvailable.end());
+
+    mAttendeeList = std::move(attendees);
+    mAttendeeAvailable = std::move(available);
+    mResources.clear();
+    mResources.reserve(mAttendeeList.size());
+    for (const KCalendarCore::Attendee &attendee : std::as_const(mAttendeeList)) {
+        mResources.push_back(isResourceType(attendee.cuType()));
+    }
+
+    addEmptyAttendee();
+
+    endResetModel();
+}
+
 void AttendeeTableModel::setAttendees(const KCalendarCore::Attendee::List &attendees)
 {
     beginResetModel();
@@ -218,6 +278,11 @@ void AttendeeTableModel::setAttendees(const KCalendarCore::Attendee::List &atten
     mAttendeeList = attendees;
     mAttendeeAvailable.clear();
     mAttendeeAvailable.resize(attendees.size());
+    mResources.clear();
+    mResources.reserve(attendees.size());
+    for (const KCalendarCore::Attendee &attendee : attendees) {
+        mResources.push_back(isResourceType(attendee.cuType()));
+    }
 
     addEmptyAttendee();
 
@@ -229,6 +294,16 @@ KCalendarCore::Attendee::List AttendeeTableModel::attendees() const
     return mAttendeeList;
 }
 
+bool AttendeeTableModel::isResource(int row) const
+{
+    return mResources[row];
+}
+
+bool AttendeeTableModel::isResourceType(KCalendarCore::Attendee::CuType cuType)
+{
+    return cuType == KCalendarCore::Attendee::Resource || cuType == KCalendarCore::Attendee::Room;
+}
+
 void AttendeeTableModel::addEmptyAttendee()
 {
     if (mKeepEmpty) {
@@ -274,12 +349,22 @@ ResourceFilterProxyModel::ResourceFilterProxyModel(QObject *parent)
 {
 }
 
+void ResourceFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    mAttendeeModel = qobject_cast<AttendeeTableModel *>(sourceModel);
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
 bool ResourceFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
+    if (mAttendeeModel) {
+        return mAttendeeModel->isResource(sourceRow);
+    }
+
     const QModelIndex cuTypeIndex = sourceModel()->index(sourceRow, AttendeeTableModel::CuType, sourceParent);
     KCalendarCore::Attendee::CuType const cuType = static_cast<KCalendarCore::Attendee::CuType>(sourceModel()->data(cuTypeIndex).toUInt());
 
-    return cuType == KCalendarCore::Attendee::Resource || cuType == KCalendarCore::Attendee::Room;
+    return AttendeeTableModel::isResourceType(cuType);
 }
 
 AttendeeFilterProxyModel::AttendeeFilterProxyModel(QObject *parent)
@@ -287,12 +372,22 @@ AttendeeFilterProxyModel::AttendeeFilterProxyModel(QObject *parent)
 {
 }
 
+void AttendeeFilterProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    mAttendeeModel = qobject_cast<AttendeeTableModel *>(sourceModel);
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
 bool AttendeeFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
+    if (mAttendeeModel) {
+        return !mAttendeeModel->isResource(sourceRow);
+    }
+
     const QModelIndex cuTypeIndex = sourceModel()->index(sourceRow, AttendeeTableModel::CuType, sourceParent);
     KCalendarCore::Attendee::CuType const cuType = static_cast<KCalendarCore::Attendee::CuType>(sourceModel()->data(cuTypeIndex).toUInt());
 
-    return !(cuType == KCalendarCore::Attendee::Resource || cuType == KCalendarCore::Attendee::Room);
+    return !AttendeeTableModel::isResourceType(cuType);
 }
 
 #include "moc_attendeetablemodel.cpp"
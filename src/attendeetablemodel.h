@@ -6,15 +6,19 @@
 
 #pragma once
 
+#include "incidenceeditor_private_export.h"
+
 #include <KCalendarCore/Attendee>
 
 #include <QAbstractTableModel>
+#include <QMap>
 #include <QModelIndex>
+#include <QPointer>
 #include <QSortFilterProxyModel>
 
 namespace IncidenceEditorNG
 {
-class AttendeeTableModel : public QAbstractTableModel
+class INCIDENCEEDITOR_TESTS_EXPORT AttendeeTableModel : public QAbstractTableModel
 {
     Q_OBJECT
 
@@ -57,9 +61,37 @@ public:
 
     bool insertAttendee(int position, const KCalendarCore::Attendee &attendee);
 
+    /*!
+     * Inserts \a attendees in front of \a position, in one go.
+     *
+     * The views and the editors listening to the model see a single
+     * rowsInserted() for the whole list.
+     */
+    bool insertAttendees(int position, const KCalendarCore::Attendee::List &attendees);
+
+    /*!
+     * Replaces the attendee in each row that is a key of \a replacements by the
+     * attendees it maps to, in one go.
+     *
+     * The views and the editors listening to the model see a single reset
+     * instead of a removal and an insertion for every row.
+     */
+    void replaceAttendees(const QMap<int, KCalendarCore::Attendee::List> &replacements);
+
     void setAttendees(const KCalendarCore::Attendee::List &attendees);
     [[nodiscard]] KCalendarCore::Attendee::List attendees() const;
 
+    /*!
+     * Returns true if the attendee in \a row is a resource or a room, without
+     * looking at the attendee itself.
+     */
+    [[nodiscard]] bool isResource(int row) const;
+
+    /*!
+     * Returns true if \a cuType is one of the types ResourceFilterProxyModel keeps.
+     */
+    [[nodiscard]] static bool isResourceType(KCalendarCore::Attendee::CuType cuType);
+
     void setKeepEmpty(bool keepEmpty);
     [[nodiscard]] bool keepEmpty() const;
 
@@ -67,31 +99,42 @@ public:
     [[nodiscard]] bool removeEmptyLines() const;
 
 private:
-    void addEmptyAttendee();
+    INCIDENCEEDITOR_NO_EXPORT void addEmptyAttendee();
 
     KCalendarCore::Attendee::List mAttendeeList;
     std::vector<AvailableStatus> mAttendeeAvailable;
+    std::vector<bool> mResources; //!< whether each row is a resource or a room, for the filter proxies
     bool mKeepEmpty = false;
     bool mRemoveEmptyLines = false;
 };
 
-class ResourceFilterProxyModel : public QSortFilterProxyModel
+class INCIDENCEEDITOR_TESTS_EXPORT ResourceFilterProxyModel : public QSortFilterProxyModel
 {
     Q_OBJECT
 public:
     explicit ResourceFilterProxyModel(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QPointer<AttendeeTableModel> mAttendeeModel;
 };
 
-class AttendeeFilterProxyModel : public QSortFilterProxyModel
+class INCIDENCEEDITOR_TESTS_EXPORT AttendeeFilterProxyModel : public QSortFilterProxyModel
 {
     Q_OBJECT
 public:
     explicit AttendeeFilterProxyModel(QObject *parent = nullptr);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
+
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    QPointer<AttendeeTableModel> mAttendeeModel;
 };
 }
@@ -0,0 +1,47 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "attendeeutils.h"
+
+#include <QHashFunctions>
+#include <QMultiHash>
+
+namespace
+{
+// Only hashes fields Attendee::operator==() compares, so equal attendees
+// always end up in the same bucket.
+size_t attendeeHash(const KCalendarCore::Attendee &attendee)
+{
+    return qHashMulti(0, attendee.email(), attendee.name(), attendee.uid(), int(attendee.status()), int(attendee.role()));
+}
+}
+
+bool IncidenceEditorNG::sameAttendees(const KCalendarCore::Attendee::List &left, const KCalendarCore::Attendee::List &right)
+{
+    if (left.size() != right.size()) {
+        return false;
+    }
+
+    // the attendees of right not matched yet, each match is taken out
+    QMultiHash<size_t, qsizetype> unmatched;
+    unmatched.reserve(right.size());
+    for (qsizetype i = 0; i < right.size(); ++i) {
+        unmatched.insert(attendeeHash(right.at(i)), i);
+    }
+
+    for (const KCalendarCore::Attendee &attendee : left) {
+        const size_t hash = attendeeHash(attendee);
+        auto it = unmatched.find(hash);
+        while (it != unmatched.end() && it.key() == hash && right.at(it.value()) != attendee) {
+            ++it;
+        }
+        if (it == unmatched.end() || it.key() != hash) {
+            return false;
+        }
+        unmatched.erase(it);
+    }
+    return true;
+}
@@ -0,0 +1,23 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "incidenceeditor_private_export.h"
+
+#include <KCalendarCore/Attendee>
+
+namespace IncidenceEditorNG
+{
+/*!
+ * Returns true if \a left and \a right hold the same attendees, in any order,
+ * with duplicates counted.
+ *
+ * Runs in linear time, so comparing the attendees of large invitations on
+ * every change stays cheap.
+ */
+[[nodiscard]] INCIDENCEEDITOR_TESTS_EXPORT bool sameAttendees(const KCalendarCore::Attendee::List &left, const KCalendarCore::Attendee::List &right);
+} // namespace IncidenceEditorNG
@@ -0,0 +1,107 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "busyintervalindex.h"
+
+#include <algorithm>
+
+using namespace IncidenceEditorNG;
+
+BusyIntervalIndex::BusyIntervalIndex(const KCalendarCore::Period::List &busyPeriods)
+{
+    mIntervals.reserve(busyPeriods.size());
+    for (const KCalendarCore::Period &period : busyPeriods) {
+        const qint64 start = period.start().toMSecsSinceEpoch();
+        const qint64 end = period.end().toMSecsSinceEpoch();
+        if (end >= start) {
+            mIntervals.append({start, end});
+        }
+    }
+    std::sort(mIntervals.begin(), mIntervals.end(), [](const Interval &a, const Interval &b) {
+        return a.start < b.start || (a.start == b.start && a.end < b.end);
+    });
+
+    // Merge overlapping intervals. Intervals which merely touch are kept apart,
+    // an empty slot at the point where they meet is still free.
+    qsizetype merged = 0;
+    for (qsizetype i = 1; i < mIntervals.size(); ++i) {
+        Interval &last = mIntervals[merged];
+        const Interval &next = mIntervals.at(i);
+        if (next.start < last.end) {
+            last.end = std::max(last.end, next.end);
+        } else {
+            mIntervals[++merged] = next;
+        }
+    }
+    if (!mIntervals.isEmpty()) {
+        mIntervals.resize(merged + 1);
+    }
+}
+
+bool BusyIntervalIndex::isEmpty() const
+{
+    return mIntervals.isEmpty();
+}
+
+int BusyIntervalIndex::size() const
+{
+    return mIntervals.size();
+}
+
+bool BusyIntervalIndex::overlaps(qint64 start, qint64 end) const
+{
+    // the first interval which ends after start is the first one which can overlap
+    const auto it = std::upper_bound(mIntervals.cbegin(), mIntervals.cend(), start, [](qint64 value, const Interval &interval) {
+        return value < interval.end;
+    });
+    return it != mIntervals.cend() && it->start <= end;
+}
+
+qint64 BusyIntervalIndex::nextFree(qint64 from, qint64 duration) const
+{
+    // the first interval which ends after from is the first one which can overlap
+    auto it = std::upper_bound(mIntervals.cbegin(), mIntervals.cend(), from, [](qint64 value, const Interval &interval) {
+        return value < interval.end;
+    });
+    // A slot which overlaps a busy interval can only become free after its end.
+    // The following interval starts at or after that end, so walking on from
+    // here visits every interval that is jumped over exactly once.
+    qint64 candidate = from;
+    for (; it != mIntervals.cend() && it->start < candidate + duration; ++it) {
+        candidate = std::max(candidate, it->end);
+    }
+    return candidate;
+}
+
+qint64 BusyIntervalIndex::nextCommonFree(const QList<BusyIntervalIndex> &indexes, qint64 from, qint64 duration, qint64 limit, Budget *budget)
+{
+    // Leapfrog: every index in turn pushes the candidate to its own next free
+    // time, until a whole round leaves the candidate where it is.
+    const qsizetype count = indexes.size();
+    qint64 candidate = from;
+    qsizetype unchanged = 0;
+    qint64 lookups = 0;
+    for (qsizetype i = 0; unchanged < count && candidate <= limit; i = (i + 1) % count) {
+        if (budget) {
+            // reading the clock is not free, only look at it every 64 lookups
+            if (budget->steps == 0 || ((++lookups & 63) == 0 && budget->deadline.hasExpired())) {
+                budget->exhausted = true;
+                break;
+            }
+            if (budget->steps > 0) {
+                --budget->steps;
+            }
+        }
+        const qint64 next = indexes.at(i).nextFree(candidate, duration);
+        if (next == candidate) {
+            ++unchanged;
+        } else {
+            candidate = next;
+            unchanged = 1;
+        }
+    }
+    return candidate;
+}
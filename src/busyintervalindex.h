@@ -0,0 +1,89 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "incidenceeditor_private_export.h"
+
+#include <KCalendarCore/Period>
+
+#include <QDeadlineTimer>
+#include <QList>
+
+namespace IncidenceEditorNG
+{
+/*!
+ * \class IncidenceEditorNG::BusyIntervalIndex
+ * \inmodule IncidenceEditor
+ * \internal
+ *
+ * The busy periods of one attendee, sorted and merged into disjoint intervals
+ * of milliseconds since the epoch.
+ *
+ * Looking up the next free time at or after a given point is a binary search
+ * followed by one step per busy interval that is jumped over.
+ */
+class INCIDENCEEDITOR_TESTS_EXPORT BusyIntervalIndex
+{
+public:
+    /*!
+     * Limits the work done by nextCommonFree().
+     */
+    struct Budget {
+        qint64 steps = -1; //!< lookups left, negative for no limit
+        QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever);
+        bool exhausted = false; //!< set when the search gave up
+    };
+
+    BusyIntervalIndex() = default;
+
+    /*!
+     * Builds the index of \a busyPeriods, which may be unsorted and overlapping.
+     */
+    explicit BusyIntervalIndex(const KCalendarCore::Period::List &busyPeriods);
+
+    /*!
+     * Returns true if there are no busy periods.
+     */
+    [[nodiscard]] bool isEmpty() const;
+
+    /*!
+     * Returns the number of disjoint busy intervals.
+     */
+    [[nodiscard]] int size() const;
+
+    /*!
+     * Returns true if a busy period ends after \a start and starts at or before
+     * \a end. Unlike in nextFree(), a period starting right at \a end counts.
+     */
+    [[nodiscard]] bool overlaps(qint64 start, qint64 end) const;
+
+    /*!
+     * Returns the earliest time at or after \a from at which a slot of \a duration
+     * milliseconds does not overlap any busy period. Returns \a from itself if
+     * that slot is free.
+     */
+    [[nodiscard]] qint64 nextFree(qint64 from, qint64 duration) const;
+
+    /*!
+     * Returns the earliest time at or after \a from at which a slot of \a duration
+     * milliseconds is free in all \a indexes, or a time after \a limit if there is
+     * none up to \a limit.
+     *
+     * If \a budget is given, the search gives up once it is used up and marks it
+     * as exhausted.
+     */
+    [[nodiscard]] static qint64
+    nextCommonFree(const QList<BusyIntervalIndex> &indexes, qint64 from, qint64 duration, qint64 limit, Budget *budget = nullptr);
+
+private:
+    struct Interval {
+        qint64 start;
+        qint64 end;
+    };
+    QList<Interval> mIntervals; //!< ordered by start and by end, never overlapping
+};
+}
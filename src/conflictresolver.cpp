@@ -8,12 +8,15 @@
 */
 
 #include "conflictresolver.h"
+#include "freebusycache.h"
 using namespace Qt::Literals::StringLiterals;
 
 #include "incidenceeditor_debug.h"
 #include <CalendarSupport/FreeBusyItemModel>
 
-#include <QDate>
+#include <KCalendarCore/Recurrence>
+
+#include <algorithm>
 
 static constexpr int DEFAULT_RESOLUTION_SECONDS = 15 * 60; // 15 minutes, 1 slot = 15 minutes
 
@@ -25,6 +28,8 @@ ConflictResolver::ConflictResolver(QWidget *parentWidget, QObject *parent)
     , mParentWidget(parentWidget)
     , mWeekdays(7)
     , mSlotResolutionSeconds(DEFAULT_RESOLUTION_SECONDS)
+    , mLatestGeneration(std::make_shared<std::atomic<quint64>>(0))
+    , mLatestRecurringSearch(std::make_shared<std::atomic<quint64>>(0))
 {
     const QDateTime currentLocalDateTime = QDateTime::currentDateTime();
     mTimeframeConstraint = KCalendarCore::Period(currentLocalDateTime, currentLocalDateTime);
@@ -42,20 +47,32 @@ ConflictResolver::ConflictResolver(QWidget *parentWidget, QObject *parent)
     mWeekdays.setBit(5);
     mWeekdays.setBit(6); // Sunday
 
-    mMandatoryRoles.reserve(4);
-    mMandatoryRoles << KCalendarCore::Attendee::ReqParticipant << KCalendarCore::Attendee::OptParticipant << KCalendarCore::Attendee::NonParticipant
-                    << KCalendarCore::Attendee::Chair;
+    mMandatoryRoles = (1U << KCalendarCore::Attendee::ReqParticipant) | (1U << KCalendarCore::Attendee::OptParticipant)
+        | (1U << KCalendarCore::Attendee::NonParticipant) | (1U << KCalendarCore::Attendee::Chair);
 
-    connect(mFBModel, &CalendarSupport::FreeBusyItemModel::dataChanged, this, &ConflictResolver::freebusyDataChanged);
+    connect(mFBModel, &CalendarSupport::FreeBusyItemModel::rowsInserted, this, &ConflictResolver::slotFreeBusyRowsInserted);
+    connect(mFBModel, &CalendarSupport::FreeBusyItemModel::rowsRemoved, this, &ConflictResolver::slotFreeBusyRowsRemoved);
+    connect(mFBModel, &CalendarSupport::FreeBusyItemModel::dataChanged, this, &ConflictResolver::slotFreeBusyItemChanged);
+    connect(mFBModel, &CalendarSupport::FreeBusyItemModel::modelReset, this, &ConflictResolver::slotFreeBusyModelReset);
+    connect(mFBModel, &CalendarSupport::FreeBusyItemModel::layoutChanged, this, &ConflictResolver::slotFreeBusyModelReset);
 
-    connect(&mCalculateTimer, &QTimer::timeout, this, &ConflictResolver::findAllFreeSlots);
+    connect(&mCalculateTimer, &QTimer::timeout, this, &ConflictResolver::startSearch);
     mCalculateTimer.setSingleShot(true);
+
+    // a newer search cancels the older ones, so there is no point in running them side by side
+    mThreadPool.setMaxThreadCount(1);
+}
+
+ConflictResolver::~ConflictResolver()
+{
+    // cancel the running search, mThreadPool waits for it to return
+    ++*mLatestGeneration;
 }
 
 void ConflictResolver::insertAttendee(const KCalendarCore::Attendee &attendee)
 {
     if (!mFBModel->containsAttendee(attendee)) {
-        mFBModel->addItem(CalendarSupport::FreeBusyItem::Ptr(new CalendarSupport::FreeBusyItem(attendee, mParentWidget)));
+        mFBModel->addItem(FreeBusyCache::self()->createItem(attendee, mTimeframeConstraint, mParentWidget));
     }
 }
 
@@ -86,43 +103,50 @@ void ConflictResolver::setEarliestDate(QDate newDate)
 {
     QDateTime newStart = mTimeframeConstraint.start();
     newStart.setDate(newDate);
-    mTimeframeConstraint = KCalendarCore::Period(newStart, mTimeframeConstraint.end());
-    calculateConflicts();
+    setTimeframe(KCalendarCore::Period(newStart, mTimeframeConstraint.end()));
 }
 
 void ConflictResolver::setEarliestTime(QTime newTime)
 {
     QDateTime newStart = mTimeframeConstraint.start();
     newStart.setTime(newTime);
-    mTimeframeConstraint = KCalendarCore::Period(newStart, mTimeframeConstraint.end());
-    calculateConflicts();
+    setTimeframe(KCalendarCore::Period(newStart, mTimeframeConstraint.end()));
 }
 
 void ConflictResolver::setLatestDate(QDate newDate)
 {
     QDateTime newEnd = mTimeframeConstraint.end();
     newEnd.setDate(newDate);
-    mTimeframeConstraint = KCalendarCore::Period(mTimeframeConstraint.start(), newEnd);
-    calculateConflicts();
+    setTimeframe(KCalendarCore::Period(mTimeframeConstraint.start(), newEnd));
 }
 
 void ConflictResolver::setLatestTime(QTime newTime)
 {
     QDateTime newEnd = mTimeframeConstraint.end();
     newEnd.setTime(newTime);
-    mTimeframeConstraint = KCalendarCore::Period(mTimeframeConstraint.start(), newEnd);
-    calculateConflicts();
+    setTimeframe(KCalendarCore::Period(mTimeframeConstraint.start(), newEnd));
 }
 
 void ConflictResolver::setEarliestDateTime(const QDateTime &newDateTime)
 {
-    mTimeframeConstraint = KCalendarCore::Period(newDateTime, mTimeframeConstraint.end());
-    calculateConflicts();
+    setTimeframe(KCalendarCore::Period(newDateTime, mTimeframeConstraint.end()));
 }
 
 void ConflictResolver::setLatestDateTime(const QDateTime &newDateTime)
 {
-    mTimeframeConstraint = KCalendarCore::Period(mTimeframeConstraint.start(), newDateTime);
+    setTimeframe(KCalendarCore::Period(mTimeframeConstraint.start(), newDateTime));
+}
+
+void ConflictResolver::setTimeframe(const KCalendarCore::Period &timeframe)
+{
+    // compare the representation too, the slots are laid out in the time zone of the start
+    const auto same = [](const QDateTime &left, const QDateTime &right) {
+        return left == right && left.timeRepresentation() == right.timeRepresentation();
+    };
+    if (same(timeframe.start(), mTimeframeConstraint.start()) && same(timeframe.end(), mTimeframeConstraint.end())) {
+        return;
+    }
+    mTimeframeConstraint = timeframe;
     calculateConflicts();
 }
 
@@ -131,104 +155,162 @@ void ConflictResolver::freebusyDataChanged()
     calculateConflicts();
 }
 
-int ConflictResolver::tryDate(QDateTime &tryFrom, QDateTime &tryTo)
+void ConflictResolver::updateAttendeeRow(int row)
 {
-    int conflicts_count = 0;
-    for (int i = 0; i < mFBModel->rowCount(); ++i) {
-        QModelIndex const index = mFBModel->index(i);
-        auto attendee = mFBModel->data(index, CalendarSupport::FreeBusyItemModel::AttendeeRole).value<KCalendarCore::Attendee>();
-        if (!matchesRoleConstraint(attendee)) {
-            continue;
-        }
-        auto freebusy = mFBModel->data(index, CalendarSupport::FreeBusyItemModel::FreeBusyRole).value<KCalendarCore::FreeBusy::Ptr>();
-        if (!tryDate(freebusy, tryFrom, tryTo)) {
-            ++conflicts_count;
-        }
+    const QModelIndex index = mFBModel->index(row);
+    const auto attendee = mFBModel->data(index, CalendarSupport::FreeBusyItemModel::AttendeeRole).value<KCalendarCore::Attendee>();
+    AttendeeRow &attendeeRow = mAttendeeRows[row];
+    attendeeRow.role = attendee.role();
+    attendeeRow.attendee.email = attendee.email();
+    attendeeRow.attendee.freeBusy = mFBModel->data(index, CalendarSupport::FreeBusyItemModel::FreeBusyRole).value<KCalendarCore::FreeBusy::Ptr>();
+    attendeeRow.attendee.revision = ++mFreeBusyRevision;
+    attendeeRow.indexed = false;
+}
+
+void ConflictResolver::slotFreeBusyRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        // new busy periods below an attendee
+        updateAttendeeRow(parent.row());
+        return;
+    }
+    mAttendeeRows.insert(first, last - first + 1, AttendeeRow());
+    for (int i = first; i <= last; ++i) {
+        updateAttendeeRow(i);
+    }
+}
+
+void ConflictResolver::slotFreeBusyRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if (parent.isValid()) {
+        updateAttendeeRow(parent.row());
+        return;
     }
-    return conflicts_count;
+    mAttendeeRows.remove(first, last - first + 1);
 }
 
-bool ConflictResolver::tryDate(const KCalendarCore::FreeBusy::Ptr &fb, QDateTime &tryFrom, QDateTime &tryTo)
+void ConflictResolver::slotFreeBusyItemChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight)
 {
-    // If we don't have any free/busy information, assume the
-    // participant is free. Otherwise a participant without available
-    // information would block the whole allocation.
-    if (!fb) {
-        return true;
+    // Changes to the periods below an attendee are reported on the attendee row
+    const QModelIndex first = topLeft.parent().isValid() ? topLeft.parent() : topLeft;
+    const QModelIndex last = bottomRight.parent().isValid() ? bottomRight.parent() : bottomRight;
+    for (int i = first.row(); i <= last.row(); ++i) {
+        updateAttendeeRow(i);
     }
+    freebusyDataChanged();
+}
 
-    KCalendarCore::Period::List busyPeriods = fb->busyPeriods();
-    for (auto it = busyPeriods.begin(); it != busyPeriods.end(); ++it) {
-        if ((*it).end() <= tryFrom // busy period ends before try period
-            || (*it).start() >= tryTo) { // busy period starts after try period
-            continue;
-        } else {
-            // the current busy period blocks the try period, try
-            // after the end of the current busy period
-            const qint64 secsDuration = tryFrom.secsTo(tryTo);
-            tryFrom = (*it).end();
-            tryTo = tryFrom.addSecs(secsDuration);
-            // try again with the new try period
-            tryDate(fb, tryFrom, tryTo);
-            // we had to change the date at least once
-            return false;
-        }
+void ConflictResolver::slotFreeBusyModelReset()
+{
+    mRowCache = FreeSlotSearch::RowCache();
+    mAttendeeRows.clear();
+    mAttendeeRows.resize(mFBModel->rowCount());
+    for (int i = 0; i < mAttendeeRows.size(); ++i) {
+        updateAttendeeRow(i);
     }
-    return true;
 }
 
 bool ConflictResolver::findFreeSlot(const KCalendarCore::Period &dateTimeRange)
 {
-    QDateTime dtFrom = dateTimeRange.start();
-    QDateTime dtTo = dateTimeRange.end();
-    if (tryDate(dtFrom, dtTo)) {
-        // Current time is acceptable
-        return true;
+    return searchFreeSlot(dateTimeRange).status == FreeSlotFound;
+}
+
+ConflictResolver::FreeSlotResult ConflictResolver::searchFreeSlot(const KCalendarCore::Period &dateTimeRange)
+{
+    QList<BusyIntervalIndex> busyIndexes;
+    const QList<FreeSlotSearch::Attendee> attendees = searchAttendees();
+    busyIndexes.reserve(attendees.size());
+    for (const FreeSlotSearch::Attendee &attendee : attendees) {
+        if (attendee.mandatory) {
+            busyIndexes.append(attendee.busyIndex);
+        }
     }
 
-    QDateTime tryFrom = dtFrom;
-    QDateTime tryTo = dtTo;
+    const QDateTime dtFrom = dateTimeRange.start();
+    const qint64 from = dtFrom.toMSecsSinceEpoch();
+    const qint64 duration = dtFrom.msecsTo(dateTimeRange.end());
+    if (BusyIntervalIndex::nextCommonFree(busyIndexes, from, duration, from) == from) {
+        // Current time is acceptable
+        return {FreeSlotFound, dateTimeRange};
+    }
 
     // Make sure that we never suggest a date in the past, even if the
     // user originally scheduled the meeting to be in the past.
-    QDateTime const now = QDateTime::currentDateTimeUtc();
-    if (tryFrom < now) {
-        // The slot to look for is at least partially in the past.
-        const qint64 secs = tryFrom.secsTo(tryTo);
-        tryFrom = now;
-        tryTo = tryFrom.addSecs(secs);
-    }
-
-    bool found = false;
-    while (!found) {
-        found = tryDate(tryFrom, tryTo);
-        // PENDING(kalle) Make the interval configurable
-        if (!found && dtFrom.daysTo(tryFrom) > 365) {
-            break; // don't look more than one year in the future
-        }
+    const qint64 tryFrom = std::max(from, QDateTime::currentMSecsSinceEpoch());
+
+    // don't look further than the search horizon
+    const qint64 limit = dtFrom.date().addDays(mSearchHorizonDays + 1).startOfDay(dtFrom.timeRepresentation()).toMSecsSinceEpoch() - 1;
+
+    BusyIntervalIndex::Budget budget;
+    if (mMaxSearchSteps > 0) {
+        budget.steps = mMaxSearchSteps;
     }
+    if (mMaxSearchTimeMSecs > 0) {
+        budget.deadline = QDeadlineTimer(mMaxSearchTimeMSecs);
+    }
+    const qint64 next = BusyIntervalIndex::nextCommonFree(busyIndexes, tryFrom, duration, limit, &budget);
+    if (budget.exhausted) {
+        qCDebug(INCIDENCEEDITOR_LOG) << "free slot search ran out of budget";
+        return {BudgetExhausted, {}};
+    }
+    if (next > limit) {
+        return {HorizonReached, {}};
+    }
+    const QDateTime slotStart = QDateTime::fromMSecsSinceEpoch(next, dtFrom.timeRepresentation());
+    return {FreeSlotFound, KCalendarCore::Period(slotStart, slotStart.addMSecs(duration))};
+}
 
-    dtFrom = tryFrom;
-    dtTo = tryTo;
+void ConflictResolver::setSearchHorizon(int days)
+{
+    mSearchHorizonDays = std::max(days, 0);
+}
 
-    return found;
+int ConflictResolver::searchHorizon() const
+{
+    return mSearchHorizonDays;
+}
+
+void ConflictResolver::setMaxSearchSteps(int steps)
+{
+    mMaxSearchSteps = std::max(steps, 0);
+}
+
+void ConflictResolver::setMaxSearchTime(int msecs)
+{
+    mMaxSearchTimeMSecs = std::max(msecs, 0);
 }
 
 void ConflictResolver::findAllFreeSlots()
 {
-    // Uses an O(p*n) (n number of attendees, p timeframe range / timeslot resolution ) algorithm to
-    // locate all free blocks in a given timeframe that match the search constraints.
-    // Does so by:
-    // 1. convert each attendees schedule for the timeframe into a bitarray according to
-    //    the time resolution, where each time slot has a value of 1 = busy, 0 = free.
-    // 2. align the arrays vertically, and sum the columns
-    // 3. the resulting summation indicates # of conflicts at each timeslot
-    // 4. locate contiguous timeslots with a values of 0. these are the free time blocks.
+    // Searches synchronously. Searches started by calculateConflicts() are not
+    // affected, they still deliver their results unless the data changes.
+    FreeSlotSearch search = createSearch();
+    search.run();
+    mRowCache = search.rowCache();
+    takeFreeSlots(search);
+}
 
-    // define these locally for readability
-    const QDateTime begin = mTimeframeConstraint.start();
-    const QDateTime end = mTimeframeConstraint.end();
+void ConflictResolver::takeFreeSlots(const FreeSlotSearch &search)
+{
+    if (search.hasFreeSlots()) {
+        mSummaryFreeRuns = search.freeRuns();
+        mSummarySlots = search.slotCount();
+        mSummary.reset();
+        mSummaryTimeframe = search.timeframe();
+        mSummaryResolutionSeconds = search.resolutionSeconds();
+        mAvailableSlots = search.freeSlots();
+        if (!mAvailableSlots.isEmpty()) {
+            Q_EMIT freeSlotsAvailable(mAvailableSlots);
+        }
+    }
+    if (search.hasRankedSlots()) {
+        mRankedSlots = search.rankedSlots();
+        Q_EMIT rankedSlotsAvailable(mRankedSlots);
+    }
+}
 
+FreeSlotSearch ConflictResolver::createSearch()
+{
     // calculate the time resolution
     // each timeslot in the arrays represents a unit of time
     // specified here.
@@ -237,223 +319,160 @@ void ConflictResolver::findAllFreeSlots()
         mSlotResolutionSeconds = DEFAULT_RESOLUTION_SECONDS;
     }
 
-    // calculate the length of the timeframe in terms of the amount of timeslots.
-    // Example: 1 week timeframe, with resolution of 15 minutes
-    //          1 week = 10080 minutes / 15 = 672 15 min timeslots
-    //          So, the array would have a length of 672
-    const int range = begin.secsTo(end) / mSlotResolutionSeconds;
-    if (range <= 0) {
-        return;
+    FreeSlotSearch search(mTimeframeConstraint, mSlotResolutionSeconds, mWeekdays, searchAttendees());
+    switch (mFreeSlotEngine) {
+    case AutomaticEngine:
+        search.setEngine(FreeSlotSearch::Engine::Automatic);
+        break;
+    case BitmapEngine:
+        search.setEngine(FreeSlotSearch::Engine::Bitmap);
+        break;
+    case SweepEngine:
+        search.setEngine(FreeSlotSearch::Engine::Sweep);
+        break;
+    case TiledEngine:
+        search.setEngine(FreeSlotSearch::Engine::Tiled);
+        break;
+    }
+    search.setTileSize(mTileSize);
+    search.setRowCache(mRowCache);
+    if (mRankedSlotCount > 0) {
+        search.setRanking(mRankedSlotDurationSeconds, mRankedSlotCount, mSlotWeights);
     }
+    return search;
+}
 
-    qCDebug(INCIDENCEEDITOR_LOG) << "from " << begin << " to " << end << "; mSlotResolutionSeconds = " << mSlotResolutionSeconds << "; range = " << range;
-    // filter out attendees for which we don't have FB data
-    // and which don't match the mandatory role constraint
-    QList<KCalendarCore::FreeBusy::Ptr> filteredFBItems;
-    for (int i = 0; i < mFBModel->rowCount(); ++i) {
-        QModelIndex const index = mFBModel->index(i);
-        auto attendee = mFBModel->data(index, CalendarSupport::FreeBusyItemModel::AttendeeRole).value<KCalendarCore::Attendee>();
-        if (!matchesRoleConstraint(attendee)) {
+QList<FreeSlotSearch::Attendee> ConflictResolver::searchAttendees()
+{
+    // filter out attendees for which we don't have FB data,
+    // and flag the ones which match the mandatory role constraint
+    QList<FreeSlotSearch::Attendee> attendees;
+    attendees.reserve(mAttendeeRows.size());
+    for (AttendeeRow &row : mAttendeeRows) {
+        FreeSlotSearch::Attendee &attendee = row.attendee;
+        if (!attendee.freeBusy) {
             continue;
         }
-        auto freebusy = mFBModel->data(index, CalendarSupport::FreeBusyItemModel::FreeBusyRole).value<KCalendarCore::FreeBusy::Ptr>();
-        if (freebusy) {
-            filteredFBItems << freebusy;
+        if (!row.indexed) {
+            attendee.periods = attendee.freeBusy->busyPeriods();
+            attendee.fullPeriods = attendee.freeBusy->fullBusyPeriods();
+            attendee.busyIndex = BusyIntervalIndex(attendee.periods);
+            row.indexed = true;
         }
+        attendee.mandatory = matchesRoleConstraint(row.role);
+        attendee.workingHours = mWorkingHours.isEmpty() ? FreeSlotSearch::WorkingHours() : mWorkingHours.value(attendee.email);
+        attendees.append(attendee);
     }
+    return attendees;
+}
 
-    // now we know the number of attendees we are calculating for
-    const int number_attendees = filteredFBItems.size();
-    if (number_attendees <= 0) {
-        qCDebug(INCIDENCEEDITOR_LOG) << "no attendees match search criteria";
-        return;
+void ConflictResolver::startSearch()
+{
+    qCDebug(INCIDENCEEDITOR_LOG) << "recalculating conflicts";
+    FreeSlotSearch search = createSearch();
+    search.setCountConflicts(true);
+    // calculateConflicts() started a new generation for the changes already
+    const quint64 generation = mLatestGeneration->load();
+    search.setGeneration(mLatestGeneration, generation);
+    if (mProgressiveChunkSeconds > 0) {
+        search.setProgressive(mProgressiveChunkSeconds, [this, generation](int first, const KCalendarCore::Period::List &slots) {
+            QMetaObject::invokeMethod(
+                this,
+                [this, generation, first, slots]() {
+                    if (mLatestGeneration->load() == generation) {
+                        Q_EMIT freeSlotsBatchAvailable(first, slots);
+                    }
+                },
+                Qt::QueuedConnection);
+        });
     }
-    qCDebug(INCIDENCEEDITOR_LOG) << "num attendees: " << number_attendees;
-    // this is a 2 dimensional array where the rows are attendees
-    // and the columns are 0 or 1 denoting free or busy respectively.
-    QList<QList<int>> fbTable;
-
-    // Explanation of the following loop:
-    // iterate: through each attendee
-    //   allocate: an array of length <range> and fill it with 0s
-    //   iterate: through each attendee's busy period
-    //     if: the period lies inside our timeframe
-    //     then:
-    //       calculate the array index within the timeframe range of the beginning of the busy period
-    //       fill from that index until the period ends with a 1, representing busy
-    //     fi
-    //   etareti
-    // append the allocated array to <fbTable>
-    // etareti
-    for (const KCalendarCore::FreeBusy::Ptr &currentFB : std::as_const(filteredFBItems)) {
-        Q_ASSERT(currentFB); // sanity check
-        const KCalendarCore::Period::List busyPeriods = currentFB->busyPeriods();
-        QList<int> fbArray(range);
-        fbArray.fill(0); // initialize to zero
-        for (const auto &period : busyPeriods) {
-            if (period.end() >= begin && period.start() <= end) {
-                int start_index = -1; // Initialize it to an invalid value.
-                int duration = -1; // Initialize it to an invalid value.
-                // case1: the period is completely in our timeframe
-                if (period.end() <= end && period.start() >= begin) {
-                    start_index = begin.secsTo(period.start()) / mSlotResolutionSeconds;
-                    duration = period.start().secsTo(period.end()) / mSlotResolutionSeconds;
-                    duration -= 1; // vector starts at 0
-                    // case2: the period begins before our timeframe begins
-                } else if (period.start() <= begin && period.end() <= end) {
-                    start_index = 0;
-                    duration = (begin.secsTo(period.end()) / mSlotResolutionSeconds) - 1;
-                    // case3: the period ends after our timeframe ends
-                } else if (period.end() >= end && period.start() >= begin) {
-                    start_index = begin.secsTo(period.start()) / mSlotResolutionSeconds;
-                    duration = range - start_index - 1;
-                    // case4: case2+case3: our timeframe is inside the period
-                } else if (period.start() <= begin && period.end() >= end) {
-                    start_index = 0;
-                    duration = range - 1;
-                } else {
-                    // QT5
-                    // qCCritical(INCIDENCEEDITOR_LOG) << "impossible condition reached" << period.start() << period.end();
-                }
-                //      qCDebug(INCIDENCEEDITOR_LOG) << start_index << "+" << duration << "="
-                //               << start_index + duration << "<=" << range;
-                Q_ASSERT((start_index + duration) < range); // sanity check
-                for (int i = start_index; i <= start_index + duration; ++i) {
-                    fbArray[i] = 1;
-                }
-            }
+    mThreadPool.start([this, search]() mutable {
+        if (search.run()) {
+            QMetaObject::invokeMethod(
+                this,
+                [this, search]() {
+                    applySearch(search);
+                },
+                Qt::QueuedConnection);
         }
-        Q_ASSERT(fbArray.size() == range); // sanity check
-        fbTable.append(fbArray);
-    }
-
-    Q_ASSERT(fbTable.size() == number_attendees);
+    });
+}
 
-    // Now, create another array to represent the allowed weekdays constraints
-    // All days which are not allowed, will be marked as busy
-    QList<int> fbArray(range);
-    fbArray.fill(0); // initialize to zero
-    for (int slot = 0; slot < fbArray.size(); ++slot) {
-        const QDateTime dateTime = begin.addSecs(slot * mSlotResolutionSeconds);
-        const int dayOfWeek = dateTime.date().dayOfWeek() - 1; // bitarray is 0 indexed
-        if (!mWeekdays[dayOfWeek]) {
-            fbArray[slot] = 1;
-        }
+void ConflictResolver::applySearch(const FreeSlotSearch &search)
+{
+    if (search.isCancelled()) {
+        qCDebug(INCIDENCEEDITOR_LOG) << "dropping the results of outdated search" << search.generation();
+        return;
     }
-    fbTable.append(fbArray);
-
-    // Create the composite array that will hold the sums for
-    // each 15 minute timeslot
-    QList<int> summed(range);
-    summed.fill(0); // initialize to zero
+    mRowCache = search.rowCache();
+    Q_EMIT conflictsDetected(search.conflictCount());
+    takeFreeSlots(search);
+}
 
-    // Sum the columns of the table
-    for (int i = 0; i < fbTable.size(); ++i) {
-        for (int j = 0; j < range; ++j) {
-            summed[j] += fbTable[i][j];
-        }
-    }
+void ConflictResolver::calculateConflicts()
+{
+    // the data changed, whatever is running now is outdated
+    ++*mLatestGeneration;
 
-    // Finally, iterate through the composite array locating contiguous free timeslots
-    int free_count = 0;
-    bool free_found = false;
-    mAvailableSlots.clear();
-    for (int i = 0; i < range; ++i) {
-        // free timeslot encountered, increment counter
-        if (summed[i] == 0) {
-            ++free_count;
-        }
-        /* cppcheck-suppress knownConditionTrueFalse */
-        if (summed[i] != 0 || (i == (range - 1) && summed[i] == 0)) {
-            // current slot is not free, so push the previous free blocks
-            // OR we are in the last slot and it is free
-            if (free_count > 0) {
-                int free_start_i; // start index of the free block
-                int free_end_i; // end index of the free block
-                if (summed[i] == 0) {
-                    // special case: we are on the last slot and it is free
-                    //               so we want to include this slot in the free block
-                    free_start_i = i - free_count + 1; // add one, to set us back inside the array because
-                    // free_count was incremented already this iteration
-                    free_end_i = i + 1; // add one to compensate for the fact that the array is 0 indexed
-                } else {
-                    free_start_i = i - free_count;
-                    free_end_i = i - 1 + 1; // add one to compensate for the fact that the array is 0 indexed
-                    // compiler will optimize out the -1+1, but I leave it here to make the reasoning apparent.
-                }
-                // convert from our timeslot interval back into to normal seconds
-                // then calculate the date times of the free block based on
-                // our initial timeframe
-                const QDateTime freeBegin = begin.addSecs(free_start_i * mSlotResolutionSeconds);
-                const QDateTime freeEnd = freeBegin.addSecs((free_end_i - free_start_i) * mSlotResolutionSeconds);
-                // push the free block onto the list
-                mAvailableSlots << KCalendarCore::Period(freeBegin, freeEnd);
-                free_count = 0;
-                free_found = true;
-            }
-        }
+    // restarting debounces, with no delay the changes up to the next event loop pass are merged
+    if (mCalculateTimer.interval() > 0 || !mCalculateTimer.isActive()) {
+        mCalculateTimer.start();
     }
-    if (free_found) {
-        Q_EMIT freeSlotsAvailable(mAvailableSlots);
-    }
-// NOLINTBEGIN(readability-avoid-unconditional-preprocessor-if)
-#if 0
-    //DEBUG, dump the arrays. very helpful for debugging
-    QTextStream dump(stdout);
-    dump << "    ";
-    dump.setFieldWidth(3);
-    for (int i = 0; i < range; ++i) {   // header
-        dump << i;
-    }
-    dump.setFieldWidth(1);
-    dump << "\n\n";
-    for (int i = 0; i < number_attendees; ++i) {
-        dump.setFieldWidth(1);
-        dump << i << ":  ";
-        dump.setFieldWidth(3);
-        for (int j = 0; j < range; ++j) {
-            dump << fbTable[i][j];
-        }
-        dump << "\n\n";
-    }
-    dump.setFieldWidth(1);
-    dump << "    ";
-    dump.setFieldWidth(3);
-    for (int i = 0; i < range; ++i) {
-        dump << summed[i];
-    }
-    dump << "\n";
-#endif
-    // NOLINTEND(readability-avoid-unconditional-preprocessor-if)
 }
 
-void ConflictResolver::calculateConflicts()
+void ConflictResolver::setRecalculationDelay(int msecs)
 {
-    QDateTime start = mTimeframeConstraint.start();
-    QDateTime end = mTimeframeConstraint.end();
-    const int count = tryDate(start, end);
-    Q_EMIT conflictsDetected(count);
+    mCalculateTimer.setInterval(std::max(msecs, 0));
+}
 
-    if (!mCalculateTimer.isActive()) {
-        mCalculateTimer.start(0);
-    }
+int ConflictResolver::recalculationDelay() const
+{
+    return mCalculateTimer.interval();
 }
 
 void ConflictResolver::setAllowedWeekdays(const QBitArray &weekdays)
 {
+    if (weekdays == mWeekdays) {
+        return;
+    }
     mWeekdays = weekdays;
     calculateConflicts();
 }
 
+void ConflictResolver::setWorkingHours(const QString &email, const WorkingHours &hours)
+{
+    if (hours == mWorkingHours.value(email)) {
+        return;
+    }
+    if (hours.restricts()) {
+        mWorkingHours.insert(email, hours);
+    } else {
+        mWorkingHours.remove(email);
+    }
+    calculateConflicts();
+}
+
+ConflictResolver::WorkingHours ConflictResolver::workingHours(const QString &email) const
+{
+    return mWorkingHours.value(email);
+}
+
 void ConflictResolver::setMandatoryRoles(const QSet<KCalendarCore::Attendee::Role> &roles)
 {
-    mMandatoryRoles = roles;
+    quint32 mandatoryRoles = 0;
+    for (KCalendarCore::Attendee::Role role : roles) {
+        mandatoryRoles |= 1U << role;
+    }
+    if (mandatoryRoles == mMandatoryRoles) {
+        return;
+    }
+    mMandatoryRoles = mandatoryRoles;
     calculateConflicts();
 }
 
-bool ConflictResolver::matchesRoleConstraint(const KCalendarCore::Attendee &attendee)
+bool ConflictResolver::matchesRoleConstraint(KCalendarCore::Attendee::Role role) const
 {
-    return mMandatoryRoles.contains(attendee.role());
+    return mMandatoryRoles & (1U << role);
 }
 
 KCalendarCore::Period::List ConflictResolver::availableSlots() const
@@ -466,6 +485,247 @@ void ConflictResolver::setResolution(int seconds)
     mSlotResolutionSeconds = seconds;
 }
 
+void ConflictResolver::setFreeSlotEngine(FreeSlotEngine engine)
+{
+    mFreeSlotEngine = engine;
+}
+
+ConflictResolver::FreeSlotEngine ConflictResolver::freeSlotEngine() const
+{
+    return mFreeSlotEngine;
+}
+
+void ConflictResolver::setTileSize(int slots)
+{
+    mTileSize = std::max(slots, 1);
+}
+
+int ConflictResolver::tileSize() const
+{
+    return mTileSize;
+}
+
+void ConflictResolver::findRecurringSlots(const KCalendarCore::Recurrence &recurrence, int durationSeconds, int occurrences)
+{
+    QList<QDateTime> occurrenceStarts;
+    QDateTime occurrence = recurrence.startDateTime();
+    if (!recurrence.recursAt(occurrence)) {
+        occurrence = recurrence.getNextDateTime(occurrence);
+    }
+    while (occurrence.isValid() && occurrenceStarts.size() < occurrences) {
+        occurrenceStarts << occurrence;
+        occurrence = recurrence.getNextDateTime(occurrence);
+    }
+    if (durationSeconds <= 0) {
+        occurrenceStarts.clear();
+    }
+    if (mSlotResolutionSeconds < 1) {
+        mSlotResolutionSeconds = DEFAULT_RESOLUTION_SECONDS;
+    }
+
+    // One search per occurrence, with the timeframe moved along with the occurrence.
+    // Days and time are moved separately so the meeting keeps its wall clock time
+    // across daylight saving time changes.
+    const QList<FreeSlotSearch::Attendee> attendees = searchAttendees();
+    const quint64 generation = mLatestGeneration->load();
+    QList<FreeSlotSearch> searches;
+    searches.reserve(occurrenceStarts.size());
+    for (const QDateTime &start : std::as_const(occurrenceStarts)) {
+        const qint64 days = occurrenceStarts.constFirst().date().daysTo(start.date());
+        const int secs = occurrenceStarts.constFirst().time().secsTo(start.time());
+        const auto moved = [days, secs](const QDateTime &dateTime) {
+            return dateTime.addDays(days).addSecs(secs);
+        };
+        const KCalendarCore::Period timeframe(moved(mTimeframeConstraint.start()), moved(mTimeframeConstraint.end()));
+        FreeSlotSearch search(timeframe, mSlotResolutionSeconds, mWeekdays, attendees);
+        search.setGeneration(mLatestGeneration, generation);
+        searches << search;
+    }
+
+    // every occurrence looks up the busy periods of each mandatory attendee once
+    qint64 mandatoryAttendees = 0;
+    for (const FreeSlotSearch::Attendee &attendee : attendees) {
+        if (attendee.mandatory) {
+            ++mandatoryAttendees;
+        }
+    }
+    const qint64 stepsPerOccurrence = std::max<qint64>(mandatoryAttendees, 1);
+    BusyIntervalIndex::Budget budget;
+    if (mMaxSearchSteps > 0) {
+        budget.steps = mMaxSearchSteps;
+    }
+    if (mMaxSearchTimeMSecs > 0) {
+        budget.deadline = QDeadlineTimer(mMaxSearchTimeMSecs);
+    }
+
+    const quint64 request = ++*mLatestRecurringSearch;
+    const std::shared_ptr<const std::atomic<quint64>> latestRequest = mLatestRecurringSearch;
+    const int length = (durationSeconds + mSlotResolutionSeconds - 1) / mSlotResolutionSeconds;
+    const QDateTime begin = mTimeframeConstraint.start();
+    const int resolutionSeconds = mSlotResolutionSeconds;
+    mThreadPool.start([this, searches, budget, stepsPerOccurrence, request, latestRequest, generation, length, begin, resolutionSeconds]() mutable {
+        // every occurrence takes the same number of steps, so the step budget is known up front
+        if (budget.steps >= 0 && budget.steps < stepsPerOccurrence * searches.size()) {
+            budget.exhausted = true;
+        }
+
+        // The occurrences do not depend on each other and are searched side by side.
+        // Once one of them finds the search outdated or out of time, the ones not
+        // started yet are skipped.
+        std::atomic<bool> cancelled{false};
+        std::atomic<bool> outOfTime{false};
+        if (!budget.exhausted) {
+            QThreadPool occurrencePool;
+            for (FreeSlotSearch &search : searches) {
+                FreeSlotSearch *const occurrenceSearch = &search;
+                occurrencePool.start([occurrenceSearch, &cancelled, &outOfTime, &budget, latestRequest, request]() {
+                    if (cancelled.load() || outOfTime.load()) {
+                        return;
+                    }
+                    if (budget.deadline.hasExpired()) {
+                        outOfTime = true;
+                    } else if (!occurrenceSearch->run() || latestRequest->load(std::memory_order_relaxed) != request) {
+                        cancelled = true;
+                    }
+                });
+            }
+            occurrencePool.waitForDone();
+        }
+        if (cancelled.load()) {
+            return;
+        }
+        budget.exhausted = budget.exhausted || outOfTime.load();
+
+        // A candidate is free in an occurrence if it fits into one of its free runs.
+        QList<RecurringSlot> slots;
+        FreeSlotStatus status = HorizonReached;
+        const int candidates = searches.isEmpty() ? 0 : searches.constFirst().slotCount() - length + 1;
+        if (budget.exhausted) {
+            qCDebug(INCIDENCEEDITOR_LOG) << "recurring slot search ran out of budget";
+            status = BudgetExhausted;
+        } else if (candidates > 0) {
+            QList<int> freeDelta(candidates + 1, 0);
+            for (const FreeSlotSearch &search : std::as_const(searches)) {
+                if (search.isCancelled()) {
+                    return;
+                }
+                if (!search.hasFreeSlots()) {
+                    // nobody has free/busy information, nothing can conflict
+                    ++freeDelta[0];
+                    --freeDelta[candidates];
+                    continue;
+                }
+                const QList<FreeBusyBitmap::Run> freeRuns = search.freeRuns();
+                for (const FreeBusyBitmap::Run &run : freeRuns) {
+                    const int firstStart = run.first;
+                    const int lastStart = std::min(run.first + run.second - length, candidates - 1);
+                    if (firstStart <= lastStart) {
+                        ++freeDelta[firstStart];
+                        --freeDelta[lastStart + 1];
+                    }
+                }
+            }
+
+            slots.reserve(candidates);
+            int freeOccurrences = 0;
+            for (int start = 0; start < candidates; ++start) {
+                freeOccurrences += freeDelta.at(start);
+                const int conflicts = int(searches.size()) - freeOccurrences;
+                slots.append({begin.addSecs(qint64(start) * resolutionSeconds), conflicts});
+                if (conflicts == 0) {
+                    status = FreeSlotFound;
+                }
+            }
+        }
+
+        QMetaObject::invokeMethod(
+            this,
+            [this, request, generation, slots, status]() {
+                if (mLatestGeneration->load() != generation || mLatestRecurringSearch->load() != request) {
+                    qCDebug(INCIDENCEEDITOR_LOG) << "dropping the results of outdated recurring slot search" << request;
+                    return;
+                }
+                Q_EMIT recurringSlotsAvailable(slots, status);
+            },
+            Qt::QueuedConnection);
+    });
+}
+
+void ConflictResolver::setProgressiveSearch(int chunkSeconds)
+{
+    mProgressiveChunkSeconds = std::max(chunkSeconds, 0);
+}
+
+int ConflictResolver::progressiveSearch() const
+{
+    return mProgressiveChunkSeconds;
+}
+
+const FreeBusyPyramid &ConflictResolver::summary() const
+{
+    if (!mSummary) {
+        mSummary = FreeBusyPyramid(mSummarySlots, mSummaryFreeRuns);
+    }
+    return *mSummary;
+}
+
+bool ConflictResolver::hasFreeBlock(const KCalendarCore::Period &range, int durationSeconds) const
+{
+    if (mSummarySlots == 0) {
+        return false;
+    }
+    // the slots which lie completely inside range
+    const QDateTime begin = mSummaryTimeframe.start();
+    const qint64 fromBegin = begin.secsTo(range.start());
+    const qint64 first = fromBegin <= 0 ? 0 : (fromBegin + mSummaryResolutionSeconds - 1) / mSummaryResolutionSeconds;
+    const qint64 last = std::min<qint64>(mSummarySlots, std::max<qint64>(begin.secsTo(range.end()), 0) / mSummaryResolutionSeconds);
+    if (first >= last) {
+        return false;
+    }
+    const int length = std::max((durationSeconds + mSummaryResolutionSeconds - 1) / mSummaryResolutionSeconds, 1);
+    return summary().longestFreeRun(first, last) >= length;
+}
+
+QList<qreal> ConflictResolver::busyFractions(int bucketSeconds) const
+{
+    QList<qreal> fractions;
+    if (mSummarySlots == 0 || bucketSeconds <= 0) {
+        return fractions;
+    }
+    const int bucketSize = (bucketSeconds + mSummaryResolutionSeconds - 1) / mSummaryResolutionSeconds;
+    const QList<int> counts = summary().busyCounts(bucketSize);
+    fractions.reserve(counts.size());
+    for (int i = 0; i < counts.size(); ++i) {
+        const int slots = std::min(bucketSize, mSummarySlots - i * bucketSize);
+        fractions.append(qreal(counts.at(i)) / slots);
+    }
+    return fractions;
+}
+
+void ConflictResolver::setRankedSlotSearch(int durationSeconds, int count)
+{
+    mRankedSlotDurationSeconds = std::max(durationSeconds, 0);
+    mRankedSlotCount = std::max(count, 0);
+    if (mRankedSlotCount == 0) {
+        mRankedSlots.clear();
+    }
+}
+
+void ConflictResolver::setSlotWeights(const SlotWeights &weights)
+{
+    mSlotWeights = weights;
+}
+
+ConflictResolver::SlotWeights ConflictResolver::slotWeights() const
+{
+    return mSlotWeights;
+}
+
+QList<ConflictResolver::RankedSlot> ConflictResolver::rankedSlots() const
+{
+    return mRankedSlots;
+}
+
 CalendarSupport::FreeBusyItemModel *ConflictResolver::model() const
 {
     return mFBModel;
@@ -9,18 +9,31 @@
 
 #pragma once
 
+#include "freebusypyramid.h"
+#include "freeslotsearch.h"
 #include "incidenceeditor_export.h"
 #include <CalendarSupport/FreeBusyItem>
 
 #include <QBitArray>
+#include <QHash>
 #include <QSet>
+#include <QThreadPool>
 #include <QTimer>
 
+#include <atomic>
+#include <memory>
+#include <optional>
+
 namespace CalendarSupport
 {
 class FreeBusyItemModel;
 }
 
+namespace KCalendarCore
+{
+class Recurrence;
+}
+
 namespace IncidenceEditorNG
 {
 /*!
@@ -39,10 +52,82 @@ class INCIDENCEEDITOR_EXPORT ConflictResolver : public QObject
 {
     Q_OBJECT
 public:
+    /*!
+     * The algorithms available to findAllFreeSlots().
+     *
+     * \value AutomaticEngine Picks the engine expected to be cheaper for the current
+     *        timeframe, resolution and number of busy periods.
+     * \value BitmapEngine Rasterizes every attendee into a bitmap with one bit per slot.
+     *        Its cost grows with the length of the timeframe divided by the resolution.
+     * \value SweepEngine Merges the sorted busy periods of all attendees. Its cost only
+     *        depends on the number of busy periods.
+     * \value TiledEngine Rasterizes and combines the attendees one tile of slots at a
+     *        time, see setTileSize(). Its memory use does not grow with the timeframe,
+     *        only with the busy periods and the free slots found. Ranked suggestions,
+     *        see setRankedSlotSearch(), still take memory for every slot.
+     *        Picked automatically when the bitmaps would take too much memory.
+     *
+     * All engines return the same free slots.
+     */
+    enum FreeSlotEngine {
+        AutomaticEngine,
+        BitmapEngine,
+        SweepEngine,
+        TiledEngine
+    };
+    Q_ENUM(FreeSlotEngine)
+
+    /*!
+     * How searchFreeSlot() ended.
+     *
+     * \value FreeSlotFound A slot free for all attendees was found.
+     * \value HorizonReached There is no free slot before the search horizon.
+     * \value BudgetExhausted The search gave up before reaching the horizon,
+     *        see setMaxSearchSteps() and setMaxSearchTime().
+     */
+    enum FreeSlotStatus {
+        FreeSlotFound,
+        HorizonReached,
+        BudgetExhausted
+    };
+    Q_ENUM(FreeSlotStatus)
+
+    /*!
+     * The outcome of searchFreeSlot().
+     */
+    struct FreeSlotResult {
+        FreeSlotStatus status = HorizonReached;
+        KCalendarCore::Period slot; //!< the free slot, only valid if status is FreeSlotFound
+    };
+
+    /*!
+     * A suggested slot and its penalty, see setRankedSlotSearch().
+     */
+    using RankedSlot = FreeSlotSearch::RankedSlot;
+
+    /*!
+     * The penalties used to rank suggested slots, see setRankedSlotSearch().
+     */
+    using SlotWeights = FreeSlotSearch::SlotWeights;
+
+    /*!
+     * The hours an attendee can meet, see setWorkingHours().
+     */
+    using WorkingHours = FreeSlotSearch::WorkingHours;
+
+    /*!
+     * A candidate start time for a recurring meeting, see findRecurringSlots().
+     */
+    struct RecurringSlot {
+        QDateTime start; //!< the start of the first occurrence
+        int conflictingOccurrences = 0; //!< occurrences for which a mandatory attendee is busy
+    };
+
     /*!
      * \a parentWidget is passed to Akonadi when fetching free/busy data.
      */
     explicit ConflictResolver(QWidget *parentWidget, QObject *parent = nullptr);
+    ~ConflictResolver() override;
 
     /*!
      *  Add an attendee
@@ -82,6 +167,20 @@ public:
      */
     void setAllowedWeekdays(const QBitArray &weekdays);
 
+    /*!
+     * Constrain the free time slot search for the attendee with \a email to
+     * \a hours, given in the attendee's own time zone. Outside of them the
+     * attendee is considered busy. Pass default constructed hours to drop the
+     * constraint again.
+     * \sa setAllowedWeekdays
+     */
+    void setWorkingHours(const QString &email, const WorkingHours &hours);
+
+    /*!
+     * Returns the working hours of the attendee with \a email.
+     */
+    [[nodiscard]] WorkingHours workingHours(const QString &email) const;
+
     /*!
      * Constrain the free time slot search to the set participant roles.
      * Mandatory roles are considered the minimum required to attend
@@ -103,14 +202,166 @@ public:
     /*!
       Finds a free slot in the future which has at least the same size as
       the initial slot.
+      \sa searchFreeSlot()
     */
     [[nodiscard]] bool findFreeSlot(const KCalendarCore::Period &dateTimeRange);
 
+    /*!
+     * Looks for the earliest slot of the same length as \a dateTimeRange, starting
+     * at \a dateTimeRange or later but never in the past, which is free for all
+     * attendees matching the mandatory roles.
+     *
+     * The search stops at the search horizon or when its budget is used up.
+     */
+    [[nodiscard]] FreeSlotResult searchFreeSlot(const KCalendarCore::Period &dateTimeRange);
+
+    /*!
+     * Sets how many \a days after the start of the requested slot searchFreeSlot()
+     * looks for a free slot. Default is 365 days.
+     */
+    void setSearchHorizon(int days);
+
+    /*!
+     * Returns the number of days searchFreeSlot() looks ahead.
+     */
+    [[nodiscard]] int searchHorizon() const;
+
+    /*!
+     * Limits searchFreeSlot() to \a steps lookups in the attendees' busy periods.
+     * findRecurringSlots() counts one lookup per mandatory attendee and occurrence.
+     * 0, the default, means no limit.
+     */
+    void setMaxSearchSteps(int steps);
+
+    /*!
+     * Limits searchFreeSlot() and findRecurringSlots() to \a msecs milliseconds.
+     * 0, the default, means no limit.
+     */
+    void setMaxSearchTime(int msecs);
+
+    /*!
+     * Checks the candidate start times of a recurring meeting of \a durationSeconds
+     * against the first \a occurrences occurrences of \a recurrence.
+     *
+     * The current timeframe is where the first occurrence may be placed. For every
+     * following occurrence the timeframe is moved along by the same number of days
+     * and the same time difference, and searched for free slots like
+     * findAllFreeSlots() does.
+     *
+     * The call returns right away. The occurrences are searched side by side on
+     * worker threads and the result is delivered with recurringSlotsAvailable().
+     * Changes to the attendees or the constraints and later calls cancel the search.
+     */
+    void findRecurringSlots(const KCalendarCore::Recurrence &recurrence, int durationSeconds, int occurrences);
+
+    /*!
+     * Makes the resolver suggest the \a count best slots of \a durationSeconds along
+     * with the free slots, even when nobody is free for the whole meeting.
+     *
+     * Unlike the free slot search, which requires every mandatory attendee to be
+     * free, candidates are ranked by penalties: every attendee who is busy during a
+     * candidate adds their weight, a tentative busy period a fraction of it.
+     * Attendees outside the mandatory roles count as optional.
+     * The allowed weekdays remain a hard constraint.
+     *
+     * A \a count of 0, the default, turns the suggestions off.
+     * \sa setSlotWeights(), rankedSlotsAvailable()
+     */
+    void setRankedSlotSearch(int durationSeconds, int count);
+
+    /*!
+     * Sets the penalties used to rank suggested slots.
+     */
+    void setSlotWeights(const SlotWeights &weights);
+
+    /*!
+     * Returns the penalties used to rank suggested slots.
+     */
+    [[nodiscard]] SlotWeights slotWeights() const;
+
+    /*!
+     * Returns the best suggested slots of the last search, the lowest penalty first.
+     */
+    [[nodiscard]] QList<RankedSlot> rankedSlots() const;
+
+    /*!
+     * Returns true if the last search found a block of at least \a durationSeconds
+     * inside \a range which is free for all mandatory attendees.
+     *
+     * The question is answered from a summary of the search result in logarithmic
+     * time, so it is cheap even for a day or a week of a long timeframe. The summary
+     * is built from the free slots when it is first needed. Only whole slots inside
+     * both \a range and the searched timeframe are considered.
+     */
+    [[nodiscard]] bool hasFreeBlock(const KCalendarCore::Period &range, int durationSeconds) const;
+
+    /*!
+     * Returns for every block of \a bucketSeconds, starting at the beginning of the
+     * searched timeframe, which fraction of it is busy for a mandatory attendee.
+     * \a bucketSeconds is rounded up to whole slots of the resolution of the search.
+     *
+     * This gives coarser views of the last search result without searching again.
+     */
+    [[nodiscard]] QList<qreal> busyFractions(int bucketSeconds) const;
+
+    /*!
+     * Makes the calculations triggered by changes report the free slots in batches
+     * of about \a chunkSeconds of the timeframe each, with freeSlotsBatchAvailable(),
+     * so the first ones show up long before a long timeframe has been searched.
+     * freeSlotsAvailable() still delivers the complete list at the end.
+     *
+     * A \a chunkSeconds of 0, the default, turns progressive mode off.
+     * findAllFreeSlots() never reports batches.
+     */
+    void setProgressiveSearch(int chunkSeconds);
+
+    /*!
+     * Returns the length of the batches reported in progressive mode, 0 if it is off.
+     */
+    [[nodiscard]] int progressiveSearch() const;
+
     /*!
      * Returns the free/busy model used for storing attendee information.
      */
     CalendarSupport::FreeBusyItemModel *model() const;
 
+    /*!
+     * Selects the algorithm used by findAllFreeSlots().
+     * Default is AutomaticEngine.
+     */
+    void setFreeSlotEngine(FreeSlotEngine engine);
+
+    /*!
+     * Returns the algorithm used by findAllFreeSlots().
+     */
+    [[nodiscard]] FreeSlotEngine freeSlotEngine() const;
+
+    /*!
+     * Sets the number of \a slots TiledEngine processes at a time. Default is 65536.
+     */
+    void setTileSize(int slots);
+
+    /*!
+     * Returns the number of slots TiledEngine processes at a time.
+     */
+    [[nodiscard]] int tileSize() const;
+
+    /*!
+     * Sets the number of \a msecs to wait after a change before recalculating.
+     *
+     * Every change restarts the wait, so a burst of changes, like editing the
+     * start and the end of the timeframe, leads to a single calculation.
+     * Setters which do not change anything do not start a calculation at all.
+     * Default is 0, which still merges the changes made before returning to
+     * the event loop.
+     */
+    void setRecalculationDelay(int msecs);
+
+    /*!
+     * Returns the number of milliseconds to wait after a change before recalculating.
+     */
+    [[nodiscard]] int recalculationDelay() const;
+
 Q_SIGNALS:
     /*!
      * Emitted when the user changes the start and end dateTimes
@@ -121,6 +372,9 @@ Q_SIGNALS:
     /*!
      * Emitted when there are conflicts
      * \a number the number of conflicts
+     *
+     * Conflicts are calculated on a worker thread, the signal is only emitted
+     * for the calculation started after the latest change.
      */
     void conflictsDetected(int);
 
@@ -129,6 +383,29 @@ Q_SIGNALS:
      */
     void freeSlotsAvailable(const KCalendarCore::Period::List &);
 
+    /*!
+     * Emitted while a calculation is running in progressive mode, see
+     * setProgressiveSearch(). \a first is the position of the first of \a slots in
+     * the complete list, 0 for the first batch of a calculation.
+     */
+    void freeSlotsBatchAvailable(int first, const KCalendarCore::Period::List &slots);
+
+    /*!
+     * Emitted with the best suggested slots, if enabled with setRankedSlotSearch().
+     */
+    void rankedSlotsAvailable(const QList<IncidenceEditorNG::ConflictResolver::RankedSlot> &slots);
+
+    /*!
+     * Emitted when the search started by findRecurringSlots() is done.
+     *
+     * \a slots holds every start time on the slot grid of the first timeframe,
+     * with the number of occurrences which would conflict. \a status is
+     * FreeSlotFound if one of them is free for every occurrence, HorizonReached
+     * if none is, and BudgetExhausted, with no \a slots, if the search gave up.
+     */
+    void recurringSlotsAvailable(const QList<IncidenceEditorNG::ConflictResolver::RecurringSlot> &slots,
+                                 IncidenceEditorNG::ConflictResolver::FreeSlotStatus status);
+
 public Q_SLOTS:
     /*!
      * Set the timeframe constraints
@@ -165,6 +442,9 @@ public Q_SLOTS:
 
     /*!
      * Find all free slots matching the current constraints.
+     *
+     * Unlike the calculation triggered by changes to the attendees or the
+     * constraints, this searches synchronously.
      */
     void findAllFreeSlots();
 
@@ -175,32 +455,63 @@ public Q_SLOTS:
 
 private:
     /*!
-      Checks whether the slot specified by (tryFrom, tryTo) matches the
-      search constraints. If yes, return true. The return value is the
-      number of conflicts that were detected, and (tryFrom, tryTo) contain the next free slot for
-      that participant. In other words, the returned slot does not have to
-      be free for everybody else.
-    */
-    INCIDENCEEDITOR_NO_EXPORT int tryDate(QDateTime &tryFrom, QDateTime &tryTo);
-
-    /*!
-      Checks whether the slot specified by (tryFrom, tryTo) is available
-      for the participant with specified fb. If yes, return true. If
-      not, return false and change (tryFrom, tryTo) to contain the next
-      possible slot for this participant (not necessarily a slot that is
-      available for all participants).
-    */
-    INCIDENCEEDITOR_NO_EXPORT bool tryDate(const KCalendarCore::FreeBusy::Ptr &fb, QDateTime &tryFrom, QDateTime &tryTo);
+     * Returns the attendees for which free/busy data is available, with their busy
+     * periods indexed and flagged if they match the mandatory role constraint.
+     * Indexes are reused as long as the attendee's free/busy data does not change.
+     */
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT QList<FreeSlotSearch::Attendee> searchAttendees();
 
     /*!
-     * Checks whether the supplied attendee passes the
+     * Checks whether the supplied role passes the
      * current mandatory role constraint.
-     * Returns true if the attendee is of one of the mandatory roles, false if not
+     * Returns true if \a role is one of the mandatory roles, false if not
      */
-    INCIDENCEEDITOR_NO_EXPORT bool matchesRoleConstraint(const KCalendarCore::Attendee &attendee);
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT bool matchesRoleConstraint(KCalendarCore::Attendee::Role role) const;
 
+    /*!
+     * Schedules a calculation after the recalculation delay.
+     */
     INCIDENCEEDITOR_NO_EXPORT void calculateConflicts();
 
+    /*!
+     * Replaces the timeframe constraint, recalculating if it changed.
+     */
+    INCIDENCEEDITOR_NO_EXPORT void setTimeframe(const KCalendarCore::Period &timeframe);
+
+    /*!
+     * Takes a snapshot of the attendees and constraints for a free slot search.
+     */
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT FreeSlotSearch createSearch();
+
+    /*!
+     * Starts a search of the current generation on the thread pool.
+     */
+    INCIDENCEEDITOR_NO_EXPORT void startSearch();
+
+    /*!
+     * Takes over the results of a finished search, unless a newer one has been started.
+     */
+    INCIDENCEEDITOR_NO_EXPORT void applySearch(const FreeSlotSearch &search);
+
+    /*!
+     * Returns the summary of the last search, built on first use.
+     */
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT const FreeBusyPyramid &summary() const;
+
+    /*!
+     * Publishes the free and suggested slots found by \a search.
+     */
+    INCIDENCEEDITOR_NO_EXPORT void takeFreeSlots(const FreeSlotSearch &search);
+
+    /*!
+     * Reads the attendee and the free/busy data of model row \a row into mAttendeeRows.
+     */
+    INCIDENCEEDITOR_NO_EXPORT void updateAttendeeRow(int row);
+    INCIDENCEEDITOR_NO_EXPORT void slotFreeBusyRowsInserted(const QModelIndex &parent, int first, int last);
+    INCIDENCEEDITOR_NO_EXPORT void slotFreeBusyRowsRemoved(const QModelIndex &parent, int first, int last);
+    INCIDENCEEDITOR_NO_EXPORT void slotFreeBusyItemChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+    INCIDENCEEDITOR_NO_EXPORT void slotFreeBusyModelReset();
+
     KCalendarCore::Period mTimeframeConstraint; //!< the datetime range for outside of which
     // free slots won't be searched.
     KCalendarCore::Period::List mAvailableSlots;
@@ -212,10 +523,49 @@ private:
     CalendarSupport::FreeBusyItemModel *const mFBModel;
     QWidget *mParentWidget = nullptr;
 
-    QSet<KCalendarCore::Attendee::Role> mMandatoryRoles;
+    quint32 mMandatoryRoles = 0; //!< one bit per KCalendarCore::Attendee::Role
     QBitArray mWeekdays; //!< a 7 bit array indicating the allowed days
     //(bit 0 = Monday, value 1 = allowed).
+    QHash<QString, WorkingHours> mWorkingHours; //!< attendee email -> working hours
 
     int mSlotResolutionSeconds;
+    FreeSlotEngine mFreeSlotEngine = AutomaticEngine;
+    int mTileSize = FreeSlotSearch::DefaultTileSize;
+
+    int mSearchHorizonDays = 365;
+    int mMaxSearchSteps = 0;
+    int mMaxSearchTimeMSecs = 0;
+
+    int mProgressiveChunkSeconds = 0;
+
+    int mRankedSlotDurationSeconds = 0;
+    int mRankedSlotCount = 0;
+    SlotWeights mSlotWeights;
+    QList<RankedSlot> mRankedSlots;
+    // The free runs of the last search, summarized when first queried.
+    QList<FreeBusyBitmap::Run> mSummaryFreeRuns;
+    int mSummarySlots = 0;
+    KCalendarCore::Period mSummaryTimeframe;
+    int mSummaryResolutionSeconds = 0;
+    mutable std::optional<FreeBusyPyramid> mSummary;
+
+    /*!
+     * What the search needs to know about one top level row of mFBModel, so it
+     * does not have to go through QVariant for every row on every calculation.
+     */
+    struct AttendeeRow {
+        KCalendarCore::Attendee::Role role = KCalendarCore::Attendee::ReqParticipant;
+        FreeSlotSearch::Attendee attendee; //!< without free/busy data until it arrives
+        bool indexed = false; //!< whether the busy periods of attendee are up to date
+    };
+    QList<AttendeeRow> mAttendeeRows; //!< in model order
+    quint64 mFreeBusyRevision = 0;
+    FreeSlotSearch::RowCache mRowCache; //!< bitmap rows kept from the last search
+
+    // Every change starts a new generation, searches of older generations give up.
+    std::shared_ptr<std::atomic<quint64>> mLatestGeneration;
+    // Every findRecurringSlots() call supersedes the previous one.
+    std::shared_ptr<std::atomic<quint64>> mLatestRecurringSearch;
+    QThreadPool mThreadPool; //!< destroyed first, waits for the running search
 };
 }
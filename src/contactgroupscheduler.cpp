@@ -0,0 +1,194 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "contactgroupscheduler.h"
+#include "incidenceeditor_debug.h"
+
+#include <Akonadi/ContactGroupExpandJob>
+#include <Akonadi/ContactGroupSearchJob>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+using namespace IncidenceEditorNG;
+
+ContactGroupScheduler *ContactGroupScheduler::mSelf = nullptr;
+
+ContactGroupScheduler *ContactGroupScheduler::self()
+{
+    if (!mSelf) {
+        mSelf = new ContactGroupScheduler();
+    }
+
+    return mSelf;
+}
+
+ContactGroupScheduler::ContactGroupScheduler()
+{
+    mDeliveryTimer.setSingleShot(true);
+    mDeliveryTimer.setInterval(0);
+    connect(&mDeliveryTimer, &QTimer::timeout, this, &ContactGroupScheduler::deliver);
+}
+
+QString ContactGroupScheduler::groupKey(const KContacts::ContactGroup &group)
+{
+    return group.id().isEmpty() ? group.name() : group.id();
+}
+
+void ContactGroupScheduler::findGroups(const QString &name)
+{
+    if (name.isEmpty()) {
+        return;
+    }
+
+    const auto it = mGroups.constFind(name);
+    if (it != mGroups.cend() && !it->expiry.hasExpired()) {
+        mFoundGroups.insert(name, it->result);
+        mDeliveryTimer.start();
+        return;
+    }
+
+    if (!mPendingSearches.contains(name)) {
+        mPendingSearches.insert(name);
+        mQueue.append({name, {}});
+        startJobs();
+    }
+}
+
+void ContactGroupScheduler::expandGroup(const KContacts::ContactGroup &group)
+{
+    const QString key = groupKey(group);
+    const auto it = mMembers.constFind(key);
+    if (it != mMembers.cend() && !it->expiry.hasExpired()) {
+        mExpandedGroups.insert(key, it->result);
+        mDeliveryTimer.start();
+        return;
+    }
+
+    if (!mPendingExpansions.contains(key)) {
+        mPendingExpansions.insert(key);
+        mQueue.append({{}, group});
+        startJobs();
+    }
+}
+
+void ContactGroupScheduler::startJobs()
+{
+    while (mRunningJobs < mMaximumJobs && !mQueue.isEmpty()) {
+        const Request request = mQueue.takeFirst();
+        ++mRunningJobs;
+        if (!request.name.isEmpty()) {
+            auto job = new Akonadi::ContactGroupSearchJob();
+            job->setQuery(Akonadi::ContactGroupSearchJob::Name, request.name);
+            connect(job, &Akonadi::ContactGroupSearchJob::result, this, [this, name = request.name](KJob *job) {
+                searchResult(job, name);
+            });
+        } else {
+            auto job = new Akonadi::ContactGroupExpandJob(request.group, this);
+            connect(job, &Akonadi::ContactGroupExpandJob::result, this, [this, key = groupKey(request.group)](KJob *job) {
+                expandResult(job, key);
+            });
+            job->start();
+        }
+    }
+}
+
+void ContactGroupScheduler::searchResult(KJob *job, const QString &name)
+{
+    --mRunningJobs;
+    mPendingSearches.remove(name);
+
+    auto searchJob = qobject_cast<Akonadi::ContactGroupSearchJob *>(job);
+    Q_ASSERT(searchJob);
+    if (searchJob->error()) {
+        // reported as no group, but not remembered, so the next request tries again
+        qCWarning(INCIDENCEEDITOR_LOG) << "Unable to look up contact group" << name << ":" << searchJob->errorString();
+        mFoundGroups.insert(name, {});
+    } else {
+        insertGroups(name, searchJob->contactGroups());
+        mFoundGroups.insert(name, searchJob->contactGroups());
+    }
+    mDeliveryTimer.start();
+    startJobs();
+}
+
+void ContactGroupScheduler::expandResult(KJob *job, const QString &key)
+{
+    --mRunningJobs;
+    mPendingExpansions.remove(key);
+
+    auto expandJob = qobject_cast<Akonadi::ContactGroupExpandJob *>(job);
+    Q_ASSERT(expandJob);
+    if (expandJob->error()) {
+        qCWarning(INCIDENCEEDITOR_LOG) << "Unable to expand contact group" << key << ":" << expandJob->errorString();
+        mExpandedGroups.insert(key, {});
+    } else {
+        insertMembers(key, expandJob->contacts());
+        mExpandedGroups.insert(key, expandJob->contacts());
+    }
+    mDeliveryTimer.start();
+    startJobs();
+}
+
+void ContactGroupScheduler::deliver()
+{
+    if (!mFoundGroups.isEmpty()) {
+        Q_EMIT groupsFound(std::exchange(mFoundGroups, {}));
+    }
+    if (!mExpandedGroups.isEmpty()) {
+        Q_EMIT groupsExpanded(std::exchange(mExpandedGroups, {}));
+    }
+}
+
+void ContactGroupScheduler::insertGroups(const QString &name, const KContacts::ContactGroup::List &groups)
+{
+    mGroups.insert(name, {groups, QDeadlineTimer(std::chrono::seconds(mTimeToLive))});
+}
+
+void ContactGroupScheduler::insertMembers(const QString &key, const KContacts::Addressee::List &members)
+{
+    mMembers.insert(key, {members, QDeadlineTimer(std::chrono::seconds(mTimeToLive))});
+}
+
+void ContactGroupScheduler::setMaximumJobs(int count)
+{
+    mMaximumJobs = std::max(count, 1);
+    startJobs();
+}
+
+int ContactGroupScheduler::maximumJobs() const
+{
+    return mMaximumJobs;
+}
+
+int ContactGroupScheduler::runningJobs() const
+{
+    return mRunningJobs;
+}
+
+int ContactGroupScheduler::queuedJobs() const
+{
+    return mQueue.size();
+}
+
+void ContactGroupScheduler::setTimeToLive(int seconds)
+{
+    mTimeToLive = seconds;
+}
+
+int ContactGroupScheduler::timeToLive() const
+{
+    return mTimeToLive;
+}
+
+void ContactGroupScheduler::clear()
+{
+    mGroups.clear();
+    mMembers.clear();
+}
+
+#include "moc_contactgroupscheduler.cpp"
@@ -0,0 +1,171 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "incidenceeditor_private_export.h"
+
+#include <KContacts/Addressee>
+#include <KContacts/ContactGroup>
+
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QTimer>
+
+class KJob;
+
+namespace IncidenceEditorNG
+{
+/*!
+ * \class IncidenceEditorNG::ContactGroupScheduler
+ * \inmodule IncidenceEditor
+ * \internal
+ *
+ * Looks up and expands contact groups for the attendee editors of this
+ * process, without flooding Akonadi when many names are entered at once.
+ *
+ * At most maximumJobs() search and expand jobs run at the same time, the
+ * others wait in line. A name or group asked for again while its job is
+ * waiting or running shares that job, and the results are kept for
+ * timeToLive() seconds.
+ *
+ * Results are not reported one by one: everything that came in during one
+ * pass of the event loop is reported by a single groupsFound() and a single
+ * groupsExpanded(), so the editors can update their models in one go.
+ */
+class INCIDENCEEDITOR_TESTS_EXPORT ContactGroupScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * The number of seconds results are used for by default.
+     */
+    static constexpr int DefaultTimeToLive = 5 * 60;
+
+    /*!
+     * The number of jobs running at the same time by default.
+     */
+    static constexpr int DefaultMaximumJobs = 4;
+
+    /*!
+     * Returns the scheduler of this process.
+     */
+    static ContactGroupScheduler *self();
+
+    /*!
+     * Looks for the contact groups called \a name, reported by groupsFound().
+     */
+    void findGroups(const QString &name);
+
+    /*!
+     * Looks up the members of \a group, reported by groupsExpanded() under
+     * groupKey(\a group).
+     */
+    void expandGroup(const KContacts::ContactGroup &group);
+
+    /*!
+     * Returns the key the members of \a group are reported under: its id,
+     * or its name if it has none.
+     */
+    [[nodiscard]] static QString groupKey(const KContacts::ContactGroup &group);
+
+    /*!
+     * Stores \a groups as the contact groups called \a name.
+     */
+    void insertGroups(const QString &name, const KContacts::ContactGroup::List &groups);
+
+    /*!
+     * Stores \a members as the members of the group with the key \a key.
+     */
+    void insertMembers(const QString &key, const KContacts::Addressee::List &members);
+
+    /*!
+     * Sets the number of jobs running at the same time to \a count, at least one.
+     *
+     * \sa DefaultMaximumJobs
+     */
+    void setMaximumJobs(int count);
+
+    /*!
+     * Returns the number of jobs running at the same time.
+     */
+    [[nodiscard]] int maximumJobs() const;
+
+    /*!
+     * Returns the number of jobs running now.
+     */
+    [[nodiscard]] int runningJobs() const;
+
+    /*!
+     * Returns the number of searches and expansions waiting for a job.
+     */
+    [[nodiscard]] int queuedJobs() const;
+
+    /*!
+     * Sets the number of \a seconds results are used for.
+     *
+     * \sa DefaultTimeToLive
+     */
+    void setTimeToLive(int seconds);
+
+    /*!
+     * Returns the number of seconds results are used for.
+     */
+    [[nodiscard]] int timeToLive() const;
+
+    /*!
+     * Forgets the results, waiting and running jobs go on.
+     */
+    void clear();
+
+Q_SIGNALS:
+    /*!
+     * Emitted with the contact groups found for each name since the last
+     * time, an empty list when there is no such group.
+     */
+    void groupsFound(const QHash<QString, KContacts::ContactGroup::List> &groups);
+
+    /*!
+     * Emitted with the members of each group expanded since the last time,
+     * by groupKey().
+     */
+    void groupsExpanded(const QHash<QString, KContacts::Addressee::List> &members);
+
+private:
+    INCIDENCEEDITOR_NO_EXPORT ContactGroupScheduler();
+    INCIDENCEEDITOR_NO_EXPORT void startJobs();
+    INCIDENCEEDITOR_NO_EXPORT void searchResult(KJob *job, const QString &name);
+    INCIDENCEEDITOR_NO_EXPORT void expandResult(KJob *job, const QString &key);
+    INCIDENCEEDITOR_NO_EXPORT void deliver();
+
+    struct Request {
+        QString name; //!< the name searched for, empty for an expansion
+        KContacts::ContactGroup group; //!< the group to expand
+    };
+
+    template<typename T>
+    struct Entry {
+        T result;
+        QDeadlineTimer expiry;
+    };
+
+    QList<Request> mQueue;
+    QSet<QString> mPendingSearches; //!< names queued or searched for
+    QSet<QString> mPendingExpansions; //!< group keys queued or expanded
+    QHash<QString, Entry<KContacts::ContactGroup::List>> mGroups;
+    QHash<QString, Entry<KContacts::Addressee::List>> mMembers;
+    QHash<QString, KContacts::ContactGroup::List> mFoundGroups; //!< not reported yet
+    QHash<QString, KContacts::Addressee::List> mExpandedGroups; //!< not reported yet
+    QTimer mDeliveryTimer;
+    int mMaximumJobs = DefaultMaximumJobs;
+    int mRunningJobs = 0;
+    int mTimeToLive = DefaultTimeToLive;
+    static ContactGroupScheduler *mSelf;
+};
+}
@@ -0,0 +1,279 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "freebusybitmap.h"
+
+#include <QtAlgorithms>
+
+#if defined(Q_PROCESSOR_X86)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+
+using namespace IncidenceEditorNG;
+
+namespace
+{
+constexpr int BITS_PER_WORD = 64;
+
+constexpr qsizetype wordCount(int size)
+{
+    return (size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+}
+
+using OrWordsFunction = void (*)(quint64 *dst, const quint64 *src, qsizetype count);
+
+void orWordsScalar(quint64 *dst, const quint64 *src, qsizetype count)
+{
+    for (qsizetype i = 0; i < count; ++i) {
+        dst[i] |= src[i];
+    }
+}
+
+#if defined(__SSE2__)
+void orWordsSse2(quint64 *dst, const quint64 *src, qsizetype count)
+{
+    qsizetype i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_or_si128(a, b));
+    }
+    orWordsScalar(dst + i, src + i, count - i);
+}
+#endif
+
+// Distributions build for the baseline instruction set, so with GCC and Clang
+// the AVX2 kernel is compiled with a function level target and selected at runtime.
+#if defined(__AVX2__)
+#define INCIDENCEEDITOR_HAVE_AVX2_KERNEL
+#define INCIDENCEEDITOR_AVX2_TARGET
+#elif defined(__GNUC__) && defined(Q_PROCESSOR_X86)
+#define INCIDENCEEDITOR_HAVE_AVX2_KERNEL
+#define INCIDENCEEDITOR_AVX2_RUNTIME_CHECK
+#define INCIDENCEEDITOR_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+#if defined(INCIDENCEEDITOR_HAVE_AVX2_KERNEL)
+INCIDENCEEDITOR_AVX2_TARGET void orWordsAvx2(quint64 *dst, const quint64 *src, qsizetype count)
+{
+    qsizetype i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(a, b));
+    }
+    orWordsScalar(dst + i, src + i, count - i);
+}
+#endif
+
+OrWordsFunction resolveOrWords()
+{
+#if defined(INCIDENCEEDITOR_HAVE_AVX2_KERNEL) && !defined(INCIDENCEEDITOR_AVX2_RUNTIME_CHECK)
+    return orWordsAvx2;
+#else
+#if defined(INCIDENCEEDITOR_AVX2_RUNTIME_CHECK)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return orWordsAvx2;
+    }
+#endif
+#if defined(__SSE2__)
+    return orWordsSse2;
+#else
+    return orWordsScalar;
+#endif
+#endif
+}
+
+void orWords(quint64 *dst, const quint64 *src, qsizetype count)
+{
+    static const OrWordsFunction function = resolveOrWords();
+    function(dst, src, count);
+}
+
+// Reads the 64 bits starting at bit offset of src, which holds srcWords words.
+quint64 readWord(const quint64 *src, qsizetype srcWords, qsizetype offset)
+{
+    const qsizetype word = offset / BITS_PER_WORD;
+    const int shift = offset % BITS_PER_WORD;
+    quint64 bits = src[word] >> shift;
+    if (shift != 0 && word + 1 < srcWords) {
+        bits |= src[word + 1] << (BITS_PER_WORD - shift);
+    }
+    return bits;
+}
+
+// ORs count bits of src, starting at bit srcOffset, into dst starting at bit dstOffset.
+// Works one destination word at a time, whatever the two offsets are.
+void orBits(quint64 *dst, qsizetype dstOffset, const quint64 *src, qsizetype srcWords, qsizetype srcOffset, qsizetype count)
+{
+    while (count > 0) {
+        const int shift = dstOffset % BITS_PER_WORD;
+        const int bits = std::min<qsizetype>(BITS_PER_WORD - shift, count);
+        const quint64 mask = bits == BITS_PER_WORD ? ~quint64(0) : (quint64(1) << bits) - 1;
+        dst[dstOffset / BITS_PER_WORD] |= (readWord(src, srcWords, srcOffset) & mask) << shift;
+        dstOffset += bits;
+        srcOffset += bits;
+        count -= bits;
+    }
+}
+}
+
+FreeBusyBitmap::FreeBusyBitmap(int size)
+    : mWords(wordCount(std::max(size, 0)), 0)
+    , mSize(std::max(size, 0))
+{
+}
+
+int FreeBusyBitmap::size() const
+{
+    return mSize;
+}
+
+bool FreeBusyBitmap::testBit(int slot) const
+{
+    Q_ASSERT(slot >= 0 && slot < mSize);
+    return (mWords.at(slot / BITS_PER_WORD) >> (slot % BITS_PER_WORD)) & 1;
+}
+
+void FreeBusyBitmap::setBit(int slot)
+{
+    Q_ASSERT(slot >= 0 && slot < mSize);
+    mWords[slot / BITS_PER_WORD] |= quint64(1) << (slot % BITS_PER_WORD);
+}
+
+void FreeBusyBitmap::fill(int first, int last)
+{
+    first = std::max(first, 0);
+    last = std::min(last, mSize);
+    if (first >= last) {
+        return;
+    }
+
+    quint64 *words = mWords.data();
+    const int firstWord = first / BITS_PER_WORD;
+    const int lastWord = (last - 1) / BITS_PER_WORD;
+    const quint64 firstMask = ~quint64(0) << (first % BITS_PER_WORD);
+    const quint64 lastMask = ~quint64(0) >> (BITS_PER_WORD - 1 - ((last - 1) % BITS_PER_WORD));
+
+    if (firstWord == lastWord) {
+        words[firstWord] |= firstMask & lastMask;
+        return;
+    }
+    words[firstWord] |= firstMask;
+    std::fill(words + firstWord + 1, words + lastWord, ~quint64(0));
+    words[lastWord] |= lastMask;
+}
+
+void FreeBusyBitmap::unite(const FreeBusyBitmap &other)
+{
+    Q_ASSERT(other.mSize == mSize);
+    if (mWords.isEmpty()) {
+        return;
+    }
+    orWords(mWords.data(), other.mWords.constData(), mWords.size());
+}
+
+void FreeBusyBitmap::tile(const FreeBusyBitmap &pattern, int first, int last)
+{
+    first = std::max(first, 0);
+    last = std::min(last, mSize);
+    if (first >= last || pattern.mSize == 0) {
+        return;
+    }
+
+    quint64 *words = mWords.data();
+    const quint64 *patternWords = pattern.mWords.constData();
+    for (int slot = first; slot < last; slot += pattern.mSize) {
+        orBits(words, slot, patternWords, pattern.mWords.size(), 0, std::min(pattern.mSize, last - slot));
+    }
+}
+
+FreeBusyBitmap FreeBusyBitmap::united(const QList<FreeBusyBitmap> &rows, int size)
+{
+    FreeBusyBitmap result(size);
+    if (result.mWords.isEmpty()) {
+        return result;
+    }
+
+    // Reduce the rows block by block so the accumulator stays in the L1 cache
+    // while every row is streamed through it once.
+    static constexpr qsizetype blockWords = 512;
+    quint64 *dst = result.mWords.data();
+    const qsizetype count = result.mWords.size();
+    for (qsizetype block = 0; block < count; block += blockWords) {
+        const qsizetype blockSize = std::min(blockWords, count - block);
+        for (const FreeBusyBitmap &row : rows) {
+            Q_ASSERT(row.mSize == size);
+            orWords(dst + block, row.mWords.constData() + block, blockSize);
+        }
+    }
+    return result;
+}
+
+int FreeBusyBitmap::nextBusy(int from) const
+{
+    if (from >= mSize) {
+        return mSize;
+    }
+    from = std::max(from, 0);
+
+    qsizetype word = from / BITS_PER_WORD;
+    quint64 bits = mWords.at(word) & (~quint64(0) << (from % BITS_PER_WORD));
+    while (bits == 0) {
+        if (++word == mWords.size()) {
+            return mSize;
+        }
+        bits = mWords.at(word);
+    }
+    return std::min<int>(mSize, word * BITS_PER_WORD + qCountTrailingZeroBits(bits));
+}
+
+int FreeBusyBitmap::nextFree(int from) const
+{
+    if (from >= mSize) {
+        return mSize;
+    }
+    from = std::max(from, 0);
+
+    // The padding bits after the last slot are always zero, so they show up
+    // as free here; clamping the result to mSize takes care of that.
+    qsizetype word = from / BITS_PER_WORD;
+    quint64 bits = ~mWords.at(word) & (~quint64(0) << (from % BITS_PER_WORD));
+    while (bits == 0) {
+        if (++word == mWords.size()) {
+            return mSize;
+        }
+        bits = ~mWords.at(word);
+    }
+    return std::min<int>(mSize, word * BITS_PER_WORD + qCountTrailingZeroBits(bits));
+}
+
+QList<FreeBusyBitmap::Run> FreeBusyBitmap::freeRuns() const
+{
+    QList<Run> runs;
+    int slot = nextFree(0);
+    while (slot < mSize) {
+        const int busy = nextBusy(slot);
+        runs.append({slot, busy - slot});
+        slot = nextFree(busy);
+    }
+    return runs;
+}
+
+QList<FreeBusyBitmap::Run> FreeBusyBitmap::busyRuns() const
+{
+    QList<Run> runs;
+    int slot = nextBusy(0);
+    while (slot < mSize) {
+        const int free = nextFree(slot);
+        runs.append({slot, free - slot});
+        slot = nextBusy(free);
+    }
+    return runs;
+}
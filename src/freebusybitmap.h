@@ -0,0 +1,108 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "incidenceeditor_private_export.h"
+
+#include <QList>
+
+#include <utility>
+
+namespace IncidenceEditorNG
+{
+/*!
+ * \class IncidenceEditorNG::FreeBusyBitmap
+ * \inmodule IncidenceEditor
+ * \internal
+ *
+ * A packed row of the free/busy table used by ConflictResolver.
+ *
+ * Each time slot is stored as a single bit (1 = busy, 0 = free), 64 slots
+ * per word. Rows are combined with a vectorized OR and free blocks are
+ * located by counting trailing zero bits instead of visiting every slot.
+ *
+ * The words are implicitly shared, so copying a bitmap is cheap.
+ */
+class INCIDENCEEDITOR_TESTS_EXPORT FreeBusyBitmap
+{
+public:
+    /*!
+     * A block of consecutive slots: the first slot and the number of slots.
+     */
+    using Run = std::pair<int, int>;
+
+    FreeBusyBitmap() = default;
+
+    /*!
+     * Creates a bitmap of \a size slots, all of them free.
+     */
+    explicit FreeBusyBitmap(int size);
+
+    /*!
+     * Returns the number of slots.
+     */
+    [[nodiscard]] int size() const;
+
+    /*!
+     * Returns true if slot \a slot is marked busy.
+     */
+    [[nodiscard]] bool testBit(int slot) const;
+
+    /*!
+     * Marks slot \a slot busy.
+     */
+    void setBit(int slot);
+
+    /*!
+     * Marks the slots from \a first up to, but not including, \a last busy.
+     * The range is clipped to the size of the bitmap.
+     */
+    void fill(int first, int last);
+
+    /*!
+     * Marks every slot that is busy in \a other busy in this bitmap as well.
+     * Both bitmaps must have the same size.
+     */
+    void unite(const FreeBusyBitmap &other);
+
+    /*!
+     * Marks the busy slots of \a pattern busy in this bitmap, repeated from \a first
+     * up to, but not including, \a last. Slot 0 of the pattern lands on \a first.
+     * The range is clipped to the size of the bitmap.
+     */
+    void tile(const FreeBusyBitmap &pattern, int first, int last);
+
+    /*!
+     * Returns the bitwise OR of all \a rows, which must all have \a size slots.
+     */
+    [[nodiscard]] static FreeBusyBitmap united(const QList<FreeBusyBitmap> &rows, int size);
+
+    /*!
+     * Returns all maximal blocks of free slots, in ascending order.
+     */
+    [[nodiscard]] QList<Run> freeRuns() const;
+
+    /*!
+     * Returns all maximal blocks of busy slots, in ascending order.
+     */
+    [[nodiscard]] QList<Run> busyRuns() const;
+
+    /*!
+     * Returns the first busy slot at or after \a from, or size() if there is none.
+     */
+    [[nodiscard]] int nextBusy(int from) const;
+
+    /*!
+     * Returns the first free slot at or after \a from, or size() if there is none.
+     */
+    [[nodiscard]] int nextFree(int from) const;
+
+private:
+    QList<quint64> mWords;
+    int mSize = 0;
+};
+}
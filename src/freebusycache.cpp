@@ -0,0 +1,281 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "freebusycache.h"
+#include "incidenceeditor_debug.h"
+
+#include <Akonadi/FreeBusyManager>
+
+#include <KCalendarCore/FreeBusyPeriod>
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QScopeGuard>
+#include <QStandardPaths>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace IncidenceEditorNG;
+using namespace Qt::Literals::StringLiterals;
+
+namespace
+{
+// magic, version, retrieval time in ms, start, end, number of periods
+constexpr char fileMagic[4] = {'K', 'F', 'B', 'C'};
+constexpr quint32 fileVersion = 1;
+constexpr qsizetype headerSize = 4 + 4 + 8 + 8 + 8 + 4;
+// start, end, type
+constexpr qsizetype periodSize = 8 + 8 + 1;
+constexpr qint64 invalidTime = std::numeric_limits<qint64>::min();
+
+qint64 toSeconds(const QDateTime &dateTime)
+{
+    return dateTime.isValid() ? dateTime.toSecsSinceEpoch() : invalidTime;
+}
+
+QDateTime fromSeconds(qint64 seconds)
+{
+    return seconds == invalidTime ? QDateTime() : QDateTime::fromSecsSinceEpoch(seconds, QTimeZone::UTC);
+}
+
+template<typename T>
+void append(QByteArray &data, T value)
+{
+    char bytes[sizeof(T)];
+    qToLittleEndian(value, bytes);
+    data.append(bytes, sizeof(T));
+}
+}
+
+FreeBusyCache *FreeBusyCache::mSelf = nullptr;
+
+FreeBusyCache *FreeBusyCache::self()
+{
+    if (!mSelf) {
+        mSelf = new FreeBusyCache();
+    }
+
+    return mSelf;
+}
+
+FreeBusyCache::FreeBusyCache()
+    : mCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + u"/freebusy"_s)
+{
+    // lists retrieved for anybody else, CalendarSupport::FreeBusyItemModel included, are cached too
+    connect(Akonadi::FreeBusyManager::self(), &Akonadi::FreeBusyManager::freeBusyRetrieved, this, &FreeBusyCache::slotFreeBusyRetrieved);
+}
+
+QString FreeBusyCache::key(const QString &email)
+{
+    return email.toLower();
+}
+
+KCalendarCore::FreeBusy::Ptr FreeBusyCache::freeBusy(const QString &email, const KCalendarCore::Period &range)
+{
+    load(email);
+    const auto it = mEntries.constFind(key(email));
+    if (it == mEntries.cend() || it->retrieved.secsTo(QDateTime::currentDateTimeUtc()) >= mTimeToLive) {
+        return {};
+    }
+    const KCalendarCore::FreeBusy::Ptr &freeBusy = it->freeBusy;
+    // lists without a range of their own are assumed to cover everything
+    if (range.start().isValid() && freeBusy->dtStart().isValid() && freeBusy->dtStart() > range.start()) {
+        return {};
+    }
+    if (range.end().isValid() && freeBusy->dtEnd().isValid() && freeBusy->dtEnd() < range.end()) {
+        return {};
+    }
+    return freeBusy;
+}
+
+KCalendarCore::FreeBusy::Ptr FreeBusyCache::lastKnownFreeBusy(const QString &email)
+{
+    load(email);
+    return mEntries.value(key(email)).freeBusy;
+}
+
+bool FreeBusyCache::retrieve(const QString &email, const KCalendarCore::Period &range, QWidget *parentWidget)
+{
+    if (email.isEmpty()) {
+        return false;
+    }
+    if (freeBusy(email, range) || isRetrieving(email)) {
+        return true;
+    }
+
+    // FreeBusyManager may answer right away with its local copy, before returning
+    const QString emailKey = key(email);
+    mRetrievals.insert(emailKey, QDeadlineTimer(qint64(RetrievalTimeout) * 1000));
+    if (!Akonadi::FreeBusyManager::self()->retrieveFreeBusy(email, false, parentWidget)) {
+        mRetrievals.remove(emailKey);
+        return freeBusy(email, range) != nullptr;
+    }
+    qCDebug(INCIDENCEEDITOR_LOG) << "retrieving free/busy of" << email;
+    return true;
+}
+
+bool FreeBusyCache::isRetrieving(const QString &email) const
+{
+    const auto it = mRetrievals.constFind(key(email));
+    return it != mRetrievals.cend() && !it->hasExpired();
+}
+
+void FreeBusyCache::insert(const QString &email, const KCalendarCore::FreeBusy::Ptr &freeBusy, const QDateTime &retrieved)
+{
+    if (!freeBusy) {
+        return;
+    }
+    const QString emailKey = key(email);
+    const QDateTime time = retrieved.isValid() ? retrieved : QDateTime::currentDateTimeUtc();
+    mEntries.insert(emailKey, {freeBusy, time});
+    mLoaded.insert(emailKey);
+    if (!retrieved.isValid()) {
+        save(email, freeBusy, time);
+    }
+}
+
+CalendarSupport::FreeBusyItem::Ptr FreeBusyCache::createItem(const KCalendarCore::Attendee &attendee, const KCalendarCore::Period &range, QWidget *parentWidget)
+{
+    CalendarSupport::FreeBusyItem::Ptr const item(new CalendarSupport::FreeBusyItem(attendee, parentWidget));
+    if (const KCalendarCore::FreeBusy::Ptr freeBusy = this->freeBusy(attendee.email(), range)) {
+        item->setFreeBusy(freeBusy);
+        item->setIsDownloading(true);
+        return item;
+    }
+    // show what was known last time while the refresh runs
+    if (const KCalendarCore::FreeBusy::Ptr freeBusy = lastKnownFreeBusy(attendee.email())) {
+        item->setFreeBusy(freeBusy);
+    }
+    if (retrieve(attendee.email(), range, parentWidget)) {
+        // the model picks the list up from FreeBusyManager when it arrives
+        item->setIsDownloading(true);
+    }
+    return item;
+}
+
+void FreeBusyCache::setTimeToLive(int seconds)
+{
+    mTimeToLive = std::max(seconds, 0);
+}
+
+int FreeBusyCache::timeToLive() const
+{
+    return mTimeToLive;
+}
+
+void FreeBusyCache::setCacheDirectory(const QString &path)
+{
+    if (mCacheDirectory != path) {
+        mCacheDirectory = path;
+        mLoaded.clear();
+    }
+}
+
+QString FreeBusyCache::cacheDirectory() const
+{
+    return mCacheDirectory;
+}
+
+void FreeBusyCache::clear()
+{
+    mEntries.clear();
+    mLoaded.clear();
+    mRetrievals.clear();
+}
+
+QString FreeBusyCache::fileName(const QString &email) const
+{
+    const QByteArray hash = QCryptographicHash::hash(key(email).toUtf8(), QCryptographicHash::Sha1).toHex();
+    return mCacheDirectory + u'/' + QString::fromLatin1(hash) + u".fb"_s;
+}
+
+void FreeBusyCache::save(const QString &email, const KCalendarCore::FreeBusy::Ptr &freeBusy, const QDateTime &retrieved) const
+{
+    if (mCacheDirectory.isEmpty() || !QDir().mkpath(mCacheDirectory)) {
+        return;
+    }
+
+    KCalendarCore::FreeBusyPeriod::List periods = freeBusy->fullBusyPeriods();
+    std::sort(periods.begin(), periods.end(), [](const KCalendarCore::FreeBusyPeriod &left, const KCalendarCore::FreeBusyPeriod &right) {
+        return left.start() < right.start();
+    });
+
+    QByteArray data;
+    data.reserve(headerSize + periods.size() * periodSize);
+    data.append(fileMagic, sizeof(fileMagic));
+    append<quint32>(data, fileVersion);
+    append<qint64>(data, retrieved.toMSecsSinceEpoch());
+    append<qint64>(data, toSeconds(freeBusy->dtStart()));
+    append<qint64>(data, toSeconds(freeBusy->dtEnd()));
+    append<quint32>(data, quint32(periods.size()));
+    for (const KCalendarCore::FreeBusyPeriod &period : std::as_const(periods)) {
+        append<qint64>(data, toSeconds(period.start()));
+        append<qint64>(data, toSeconds(period.end()));
+        append<quint8>(data, quint8(period.type()));
+    }
+
+    QSaveFile file(fileName(email));
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        qCWarning(INCIDENCEEDITOR_LOG) << "Unable to write the free/busy cache" << file.fileName() << file.errorString();
+    }
+}
+
+void FreeBusyCache::load(const QString &email)
+{
+    const QString emailKey = key(email);
+    if (mCacheDirectory.isEmpty() || mLoaded.contains(emailKey)) {
+        return;
+    }
+    mLoaded.insert(emailKey);
+
+    QFile file(fileName(email));
+    if (!file.open(QIODevice::ReadOnly) || file.size() < headerSize) {
+        return;
+    }
+    const uchar *data = file.map(0, file.size());
+    if (!data) {
+        return;
+    }
+    const auto unmap = qScopeGuard([&file, data] {
+        file.unmap(const_cast<uchar *>(data));
+    });
+
+    const quint32 count = qFromLittleEndian<quint32>(data + headerSize - 4);
+    if (std::memcmp(data, fileMagic, sizeof(fileMagic)) != 0 || qFromLittleEndian<quint32>(data + 4) != fileVersion
+        || file.size() != headerSize + qint64(count) * periodSize) {
+        qCWarning(INCIDENCEEDITOR_LOG) << "Ignoring the invalid free/busy cache" << file.fileName();
+        return;
+    }
+
+    KCalendarCore::FreeBusyPeriod::List periods;
+    periods.reserve(count);
+    for (const uchar *period = data + headerSize, *end = period + qsizetype(count) * periodSize; period != end; period += periodSize) {
+        if (period[16] > quint8(KCalendarCore::FreeBusyPeriod::Unknown)) {
+            qCWarning(INCIDENCEEDITOR_LOG) << "Ignoring the free/busy cache with an invalid period type" << file.fileName();
+            return;
+        }
+        KCalendarCore::FreeBusyPeriod busyPeriod(fromSeconds(qFromLittleEndian<qint64>(period)), fromSeconds(qFromLittleEndian<qint64>(period + 8)));
+        busyPeriod.setType(KCalendarCore::FreeBusyPeriod::FreeBusyType(period[16]));
+        periods.append(busyPeriod);
+    }
+    KCalendarCore::FreeBusy::Ptr const freeBusy(new KCalendarCore::FreeBusy(periods));
+    freeBusy->setDtStart(fromSeconds(qFromLittleEndian<qint64>(data + 16)));
+    freeBusy->setDtEnd(fromSeconds(qFromLittleEndian<qint64>(data + 24)));
+    mEntries.insert(emailKey, {freeBusy, QDateTime::fromMSecsSinceEpoch(qFromLittleEndian<qint64>(data + 8), QTimeZone::UTC)});
+}
+
+void FreeBusyCache::slotFreeBusyRetrieved(const KCalendarCore::FreeBusy::Ptr &freeBusy, const QString &email)
+{
+    mRetrievals.remove(key(email));
+    insert(email, freeBusy);
+}
+
+#include "moc_freebusycache.cpp"
@@ -0,0 +1,164 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "incidenceeditor_private_export.h"
+
+#include <CalendarSupport/FreeBusyItem>
+
+#include <KCalendarCore/Attendee>
+#include <KCalendarCore/FreeBusy>
+#include <KCalendarCore/Period>
+
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+class QWidget;
+
+namespace IncidenceEditorNG
+{
+/*!
+ * \class IncidenceEditorNG::FreeBusyCache
+ * \inmodule IncidenceEditor
+ * \internal
+ *
+ * The free/busy lists retrieved by this process, shared by every
+ * ConflictResolver and ResourceManagement dialog.
+ *
+ * Each attendee's latest list is kept for timeToLive() seconds, whoever asked
+ * Akonadi::FreeBusyManager for it. While a retrieval is on its way, further
+ * requests for the same attendee wait for it instead of starting another one,
+ * and everybody gets the same FreeBusy::Ptr.
+ *
+ * The lists are also written to cacheDirectory(), so after a restart the last
+ * known availability shows up at once while the refresh runs. Each file holds
+ * a small header and the periods sorted by start, as little endian 64 bit
+ * start and end times in seconds since the epoch followed by the type byte.
+ * The files are memory mapped for reading.
+ */
+class INCIDENCEEDITOR_TESTS_EXPORT FreeBusyCache : public QObject
+{
+    Q_OBJECT
+public:
+    /*!
+     * The number of seconds retrieved free/busy lists are used for by default.
+     */
+    static constexpr int DefaultTimeToLive = 5 * 60;
+
+    /*!
+     * The number of seconds after which a retrieval that never answered no
+     * longer holds back new requests.
+     */
+    static constexpr int RetrievalTimeout = 60;
+
+    /*!
+     * Returns the cache of this process.
+     */
+    static FreeBusyCache *self();
+
+    /*!
+     * Returns the cached free/busy list of \a email, or a null pointer when
+     * there is none, it is older than timeToLive() or it does not cover \a range.
+     * An invalid \a range is covered by any list.
+     *
+     * Email addresses are compared case insensitively.
+     */
+    [[nodiscard]] KCalendarCore::FreeBusy::Ptr freeBusy(const QString &email, const KCalendarCore::Period &range = {});
+
+    /*!
+     * Returns the latest free/busy list of \a email however old it is, from
+     * memory or from the disk, or a null pointer if there never was one.
+     */
+    [[nodiscard]] KCalendarCore::FreeBusy::Ptr lastKnownFreeBusy(const QString &email);
+
+    /*!
+     * Makes sure the free/busy list of \a email covering \a range is or will
+     * be available, retrieving it unless it is cached or already on its way.
+     *
+     * Returns false if the list is not available and cannot be retrieved.
+     */
+    bool retrieve(const QString &email, const KCalendarCore::Period &range = {}, QWidget *parentWidget = nullptr);
+
+    /*!
+     * Returns true while a retrieval for \a email is on its way.
+     */
+    [[nodiscard]] bool isRetrieving(const QString &email) const;
+
+    /*!
+     * Stores \a freeBusy as the latest free/busy list of \a email, retrieved
+     * at \a retrieved or now. Newly retrieved lists are also written to the disk.
+     */
+    void insert(const QString &email, const KCalendarCore::FreeBusy::Ptr &freeBusy, const QDateTime &retrieved = {});
+
+    /*!
+     * Returns a new FreeBusyItem for \a attendee, to be added to a
+     * CalendarSupport::FreeBusyItemModel.
+     *
+     * If the attendee's list covering \a range is cached, the item gets it
+     * right away. Otherwise it gets the last known list, if any, and a refresh
+     * is started. Either way the item is marked as downloading when its list
+     * is cached or on its way, so the model does not fetch it a second time.
+     * FreeBusyItem::setFreeBusy() clears the mark when a new list arrives.
+     */
+    [[nodiscard]] CalendarSupport::FreeBusyItem::Ptr
+    createItem(const KCalendarCore::Attendee &attendee, const KCalendarCore::Period &range = {}, QWidget *parentWidget = nullptr);
+
+    /*!
+     * Sets the number of \a seconds a retrieved list is used for.
+     *
+     * \sa DefaultTimeToLive
+     */
+    void setTimeToLive(int seconds);
+
+    /*!
+     * Returns the number of seconds a retrieved list is used for.
+     */
+    [[nodiscard]] int timeToLive() const;
+
+    /*!
+     * Sets the directory the lists are written to, an empty \a path keeps
+     * them in memory only.
+     *
+     * The default is a freebusy directory in the application's cache location.
+     */
+    void setCacheDirectory(const QString &path);
+
+    /*!
+     * Returns the directory the lists are written to.
+     */
+    [[nodiscard]] QString cacheDirectory() const;
+
+    /*!
+     * Forgets the lists kept in memory, those on the disk are read again
+     * when asked for.
+     */
+    void clear();
+
+private:
+    INCIDENCEEDITOR_NO_EXPORT FreeBusyCache();
+    INCIDENCEEDITOR_NO_EXPORT void slotFreeBusyRetrieved(const KCalendarCore::FreeBusy::Ptr &freeBusy, const QString &email);
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT static QString key(const QString &email);
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT QString fileName(const QString &email) const;
+    INCIDENCEEDITOR_NO_EXPORT void save(const QString &email, const KCalendarCore::FreeBusy::Ptr &freeBusy, const QDateTime &retrieved) const;
+    INCIDENCEEDITOR_NO_EXPORT void load(const QString &email);
+
+    struct Entry {
+        KCalendarCore::FreeBusy::Ptr freeBusy;
+        QDateTime retrieved;
+    };
+
+    QHash<QString, Entry> mEntries;
+    QSet<QString> mLoaded; //!< the emails looked up on the disk already
+    QString mCacheDirectory;
+    QHash<QString, QDeadlineTimer> mRetrievals; //!< retrievals on their way, and when they time out
+    int mTimeToLive = DefaultTimeToLive;
+    static FreeBusyCache *mSelf;
+};
+}
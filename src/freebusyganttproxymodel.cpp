@@ -17,6 +17,8 @@ using namespace Qt::Literals::StringLiterals;
 
 #include <QLocale>
 
+#include <algorithm>
+
 using namespace IncidenceEditorNG;
 
 FreeBusyGanttProxyModel::FreeBusyGanttProxyModel(QObject *parent)
@@ -24,6 +26,170 @@ FreeBusyGanttProxyModel::FreeBusyGanttProxyModel(QObject *parent)
 {
 }
 
+void FreeBusyGanttProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    if (this->sourceModel()) {
+        disconnect(this->sourceModel(), nullptr, this, nullptr);
+    }
+    mMergedPeriods.clear();
+    mDisplayedPeriods.clear();
+    // connected before QSortFilterProxyModel itself, so the merged periods are
+    // up to date by the time it filters the changed rows
+    if (sourceModel) {
+        connect(sourceModel, &QAbstractItemModel::rowsInserted, this, &FreeBusyGanttProxyModel::slotSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, &FreeBusyGanttProxyModel::slotSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::dataChanged, this, &FreeBusyGanttProxyModel::slotSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::modelReset, this, &FreeBusyGanttProxyModel::slotSourceChanged);
+        connect(sourceModel, &QAbstractItemModel::layoutChanged, this, &FreeBusyGanttProxyModel::slotSourceChanged);
+    }
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
+void FreeBusyGanttProxyModel::slotSourceChanged()
+{
+    mMergedPeriods.clear();
+    mDisplayedPeriods.clear();
+    // A new or changed period can join or split the merged ones around it,
+    // which QSortFilterProxyModel does not filter again by itself.
+    if (mMergePeriods && !mRefilterPending) {
+        mRefilterPending = true;
+        QMetaObject::invokeMethod(
+            this,
+            [this]() {
+                mRefilterPending = false;
+                invalidateRowsFilter();
+            },
+            Qt::QueuedConnection);
+    }
+}
+
+void FreeBusyGanttProxyModel::setVisibleRange(const QDateTime &start, const QDateTime &end)
+{
+    if (start == mVisibleStart && end == mVisibleEnd) {
+        return;
+    }
+    mVisibleStart = start;
+    mVisibleEnd = end;
+    invalidateRowsFilter();
+}
+
+QDateTime FreeBusyGanttProxyModel::visibleStart() const
+{
+    return mVisibleStart;
+}
+
+QDateTime FreeBusyGanttProxyModel::visibleEnd() const
+{
+    return mVisibleEnd;
+}
+
+void FreeBusyGanttProxyModel::setVisibleRows(int first, int last)
+{
+    if (first < 0) {
+        first = last = -1;
+    }
+    if (first == mFirstVisibleRow && last == mLastVisibleRow) {
+        return;
+    }
+    mFirstVisibleRow = first;
+    mLastVisibleRow = last;
+    invalidateRowsFilter();
+}
+
+int FreeBusyGanttProxyModel::firstVisibleRow() const
+{
+    return mFirstVisibleRow;
+}
+
+int FreeBusyGanttProxyModel::lastVisibleRow() const
+{
+    return mLastVisibleRow;
+}
+
+void FreeBusyGanttProxyModel::setMergePeriods(bool merge)
+{
+    if (merge == mMergePeriods) {
+        return;
+    }
+    mMergePeriods = merge;
+    mDisplayedPeriods.clear();
+    invalidateRowsFilter();
+}
+
+bool FreeBusyGanttProxyModel::mergePeriods() const
+{
+    return mMergePeriods;
+}
+
+bool FreeBusyGanttProxyModel::isVisible(const QDateTime &start, const QDateTime &end) const
+{
+    return (!mVisibleStart.isValid() || end > mVisibleStart) && (!mVisibleEnd.isValid() || start < mVisibleEnd);
+}
+
+const FreeBusyGanttProxyModel::MergedPeriods &FreeBusyGanttProxyModel::mergedPeriods(const QModelIndex &sourceParent) const
+{
+    auto it = mMergedPeriods.find(sourceParent.row());
+    if (it != mMergedPeriods.end()) {
+        return *it;
+    }
+
+    struct Child {
+        QDateTime start;
+        QDateTime end;
+        int row;
+    };
+    const int rowCount = sourceModel()->rowCount(sourceParent);
+    QList<Child> children;
+    children.reserve(rowCount);
+    for (int row = 0; row < rowCount; ++row) {
+        const auto period = sourceModel()
+                                ->data(sourceModel()->index(row, 0, sourceParent), CalendarSupport::FreeBusyItemModel::FreeBusyPeriodRole)
+                                .value<KCalendarCore::FreeBusyPeriod>();
+        children.append({period.start(), period.end(), row});
+    }
+    std::stable_sort(children.begin(), children.end(), [](const Child &left, const Child &right) {
+        return left.start < right.start;
+    });
+
+    MergedPeriods merged;
+    merged.groupOfRow.fill(-1, rowCount);
+    for (const Child &child : std::as_const(children)) {
+        if (!merged.groups.isEmpty() && child.start <= merged.groups.last().end) {
+            MergedPeriod &group = merged.groups.last();
+            group.end = std::max(group.end, child.end);
+            ++group.count;
+        } else {
+            merged.groupOfRow[child.row] = merged.groups.size();
+            merged.groups.append({child.start, child.end, 1});
+        }
+    }
+    return *mMergedPeriods.insert(sourceParent.row(), merged);
+}
+
+bool FreeBusyGanttProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    // attendees are always shown
+    if (!sourceParent.isValid()) {
+        return true;
+    }
+    // decided before looking at the period, so attendees out of view cost nothing
+    if (mFirstVisibleRow >= 0 && (sourceParent.row() < mFirstVisibleRow || sourceParent.row() > mLastVisibleRow)) {
+        return false;
+    }
+    if (mMergePeriods) {
+        const MergedPeriods &merged = mergedPeriods(sourceParent);
+        const int group = merged.groupOfRow.value(sourceRow, -1);
+        return group >= 0 && isVisible(merged.groups.at(group).start, merged.groups.at(group).end);
+    }
+    if (!mVisibleStart.isValid() && !mVisibleEnd.isValid()) {
+        return true;
+    }
+    const auto period = sourceModel()
+                            ->data(sourceModel()->index(sourceRow, 0, sourceParent), CalendarSupport::FreeBusyItemModel::FreeBusyPeriodRole)
+                            .value<KCalendarCore::FreeBusyPeriod>();
+    return isVisible(period.start(), period.end());
+}
+
 QVariant FreeBusyGanttProxyModel::data(const QModelIndex &index, int role) const
 {
     if (!index.isValid()) {
@@ -44,19 +210,22 @@ QVariant FreeBusyGanttProxyModel::data(const QModelIndex &index, int role) const
     }
 
     // if the index is valid, then it corresponds to a free busy period
-    auto period = sourceModel()->data(source_index, CalendarSupport::FreeBusyItemModel::FreeBusyPeriodRole).value<KCalendarCore::FreeBusyPeriod>();
-
     switch (role) {
     case KGantt::ItemTypeRole:
         return KGantt::TypeTask;
     case KGantt::StartTimeRole:
-        return period.start().toLocalTime();
+        return displayedPeriod(source_index).start;
     case KGantt::EndTimeRole:
-        return period.end().toLocalTime();
+        return displayedPeriod(source_index).end;
     case Qt::BackgroundRole:
         return QColor(Qt::red);
-    case Qt::ToolTipRole:
-        return tooltipify(period);
+    case Qt::ToolTipRole: {
+        DisplayedPeriod &displayed = displayedPeriod(source_index);
+        if (displayed.toolTip.isNull()) {
+            displayed.toolTip = tooltipify(displayed.period);
+        }
+        return displayed.toolTip;
+    }
     case Qt::DisplayRole:
         return sourceModel()->data(source_index.parent(), Qt::DisplayRole);
     default:
@@ -64,6 +233,33 @@ QVariant FreeBusyGanttProxyModel::data(const QModelIndex &index, int role) const
     }
 }
 
+FreeBusyGanttProxyModel::DisplayedPeriod &FreeBusyGanttProxyModel::displayedPeriod(const QModelIndex &sourceIndex) const
+{
+    QList<DisplayedPeriod> &periods = mDisplayedPeriods[sourceIndex.parent().row()];
+    if (sourceIndex.row() >= periods.size()) {
+        periods.resize(sourceModel()->rowCount(sourceIndex.parent()));
+    }
+    DisplayedPeriod &displayed = periods[sourceIndex.row()];
+    if (displayed.loaded) {
+        return displayed;
+    }
+
+    auto period = sourceModel()->data(sourceIndex, CalendarSupport::FreeBusyItemModel::FreeBusyPeriodRole).value<KCalendarCore::FreeBusyPeriod>();
+    if (mMergePeriods) {
+        // the item stands for all the periods merged with this one
+        const MergedPeriods &merged = mergedPeriods(sourceIndex.parent());
+        const int group = merged.groupOfRow.value(sourceIndex.row(), -1);
+        if (group >= 0 && merged.groups.at(group).count > 1) {
+            period = KCalendarCore::FreeBusyPeriod(merged.groups.at(group).start, merged.groups.at(group).end);
+        }
+    }
+    displayed.period = period;
+    displayed.start = period.start().toLocalTime();
+    displayed.end = period.end().toLocalTime();
+    displayed.loaded = true;
+    return displayed;
+}
+
 QString FreeBusyGanttProxyModel::tooltipify(const KCalendarCore::FreeBusyPeriod &period) const
 {
     QString toolTip = u"<qt>"_s;
@@ -9,12 +9,12 @@
 
 #include "incidenceeditor_private_export.h"
 
-#include <QSortFilterProxyModel>
+#include <KCalendarCore/FreeBusyPeriod>
 
-namespace KCalendarCore
-{
-class FreeBusyPeriod;
-}
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QSortFilterProxyModel>
 
 namespace IncidenceEditorNG
 {
@@ -29,6 +29,10 @@ namespace IncidenceEditorNG
  * This model exposes the FreeBusyPeriods, which are the child level nodes
  * in FreeBusyItemModel, as a list.
  *
+ * To keep large groups cheap to draw, it can leave out the periods outside
+ * the visible time range or of attendees scrolled out of view, and merge each
+ * attendee's overlapping and adjacent periods into one item.
+ *
  * \sa FreeBusyItemMode
  * \sa FreeBusyItem
  */
@@ -37,7 +41,100 @@ class INCIDENCEEDITOR_TESTS_EXPORT FreeBusyGanttProxyModel : public QSortFilterP
     Q_OBJECT
 public:
     explicit FreeBusyGanttProxyModel(QObject *parent = nullptr);
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     [[nodiscard]] QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     [[nodiscard]] QString tooltipify(const KCalendarCore::FreeBusyPeriod &period) const;
+
+    /*!
+     * Only exposes the periods intersecting the range from \a start to \a end.
+     * Invalid date times leave the range open on that side.
+     */
+    void setVisibleRange(const QDateTime &start, const QDateTime &end);
+
+    /*!
+     * Returns the start of the range periods are exposed for.
+     */
+    [[nodiscard]] QDateTime visibleStart() const;
+
+    /*!
+     * Returns the end of the range periods are exposed for.
+     */
+    [[nodiscard]] QDateTime visibleEnd() const;
+
+    /*!
+     * Only exposes the periods of the attendees in the rows from \a first to
+     * \a last, both included. The other attendees stay in the model, without
+     * periods. A negative \a first exposes the periods of all attendees.
+     */
+    void setVisibleRows(int first, int last);
+
+    /*!
+     * Returns the first attendee row whose periods are exposed, -1 if all are.
+     */
+    [[nodiscard]] int firstVisibleRow() const;
+
+    /*!
+     * Returns the last attendee row whose periods are exposed, -1 if all are.
+     */
+    [[nodiscard]] int lastVisibleRow() const;
+
+    /*!
+     * Sets whether overlapping and adjacent periods of an attendee are
+     * exposed as a single item, for coarse scales where they are not
+     * distinguishable anyway. Off by default.
+     */
+    void setMergePeriods(bool merge);
+
+    /*!
+     * Returns whether overlapping and adjacent periods are merged.
+     */
+    [[nodiscard]] bool mergePeriods() const;
+
+protected:
+    [[nodiscard]] bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+
+private:
+    struct MergedPeriod {
+        QDateTime start;
+        QDateTime end;
+        int count = 0; //!< the number of periods merged
+    };
+
+    struct MergedPeriods {
+        QList<int> groupOfRow; //!< the group of each child row, -1 for all but the first of a group
+        QList<MergedPeriod> groups;
+    };
+
+    /*!
+     * What the item of a period shows, converted once and kept until the source changes.
+     */
+    struct DisplayedPeriod {
+        KCalendarCore::FreeBusyPeriod period; //!< the merged period when merging
+        QDateTime start; //!< in local time
+        QDateTime end; //!< in local time
+        QString toolTip; //!< built on first use
+        bool loaded = false;
+    };
+
+    /*!
+     * Returns what the item of the period at \a sourceIndex shows.
+     */
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT DisplayedPeriod &displayedPeriod(const QModelIndex &sourceIndex) const;
+
+    /*!
+     * Returns the merged periods below attendee \a sourceParent, computed on first use.
+     */
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT const MergedPeriods &mergedPeriods(const QModelIndex &sourceParent) const;
+    [[nodiscard]] INCIDENCEEDITOR_NO_EXPORT bool isVisible(const QDateTime &start, const QDateTime &end) const;
+    INCIDENCEEDITOR_NO_EXPORT void slotSourceChanged();
+
+    mutable QHash<int, MergedPeriods> mMergedPeriods; //!< by attendee row
+    mutable QHash<int, QList<DisplayedPeriod>> mDisplayedPeriods; //!< by attendee row, then period row
+    QDateTime mVisibleStart;
+    QDateTime mVisibleEnd;
+    int mFirstVisibleRow = -1;
+    int mLastVisibleRow = -1;
+    bool mMergePeriods = false;
+    bool mRefilterPending = false;
 };
 }
@@ -0,0 +1,146 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "freebusypyramid.h"
+
+#include <algorithm>
+
+using namespace IncidenceEditorNG;
+
+FreeBusyPyramid::FreeBusyPyramid(int size, const QList<FreeBusyBitmap::Run> &freeRuns)
+    : mSize(std::max(size, 0))
+{
+    if (mSize == 0) {
+        return;
+    }
+
+    // the busy stretches are the gaps between the free runs
+    QList<Node> leaves;
+    leaves.reserve(2 * freeRuns.size() + 1);
+    mStarts.reserve(2 * freeRuns.size() + 1);
+    int slot = 0;
+    for (const FreeBusyBitmap::Run &run : freeRuns) {
+        if (run.second <= 0) {
+            continue;
+        }
+        if (run.first > slot) {
+            mStarts.append(slot);
+            leaves.append({run.first - slot, run.first - slot, 0, 0, 0});
+        }
+        mStarts.append(run.first);
+        leaves.append({run.second, 0, run.second, run.second, run.second});
+        slot = run.first + run.second;
+    }
+    if (slot < mSize) {
+        mStarts.append(slot);
+        leaves.append({mSize - slot, mSize - slot, 0, 0, 0});
+    }
+
+    mLeaves = 1;
+    while (mLeaves < leaves.size()) {
+        mLeaves *= 2;
+    }
+    // The padding leaves have no length, combining with them changes nothing.
+    mNodes.resize(2 * mLeaves);
+    std::copy(leaves.cbegin(), leaves.cend(), mNodes.begin() + mLeaves);
+    for (int i = mLeaves - 1; i > 0; --i) {
+        mNodes[i] = combine(mNodes.at(2 * i), mNodes.at(2 * i + 1));
+    }
+}
+
+FreeBusyPyramid::FreeBusyPyramid(const FreeBusyBitmap &busy)
+    : FreeBusyPyramid(busy.size(), busy.freeRuns())
+{
+}
+
+int FreeBusyPyramid::size() const
+{
+    return mSize;
+}
+
+FreeBusyPyramid::Node FreeBusyPyramid::combine(const Node &left, const Node &right)
+{
+    Node node;
+    node.length = left.length + right.length;
+    node.busy = left.busy + right.busy;
+    node.prefixFree = left.prefixFree == left.length ? left.length + right.prefixFree : left.prefixFree;
+    node.suffixFree = right.suffixFree == right.length ? right.length + left.suffixFree : right.suffixFree;
+    node.longestFree = std::max({left.longestFree, right.longestFree, left.suffixFree + right.prefixFree});
+    return node;
+}
+
+FreeBusyPyramid::Node FreeBusyPyramid::stretchNode(int stretch, int length) const
+{
+    // a part of a stretch is as free or as busy as the whole stretch
+    if (mNodes.at(mLeaves + stretch).busy > 0) {
+        return {length, length, 0, 0, 0};
+    }
+    return {length, 0, length, length, length};
+}
+
+int FreeBusyPyramid::stretchEnd(int stretch) const
+{
+    return stretch + 1 < mStarts.size() ? mStarts.at(stretch + 1) : mSize;
+}
+
+int FreeBusyPyramid::stretchAt(int slot) const
+{
+    return int(std::upper_bound(mStarts.cbegin(), mStarts.cend(), slot) - mStarts.cbegin()) - 1;
+}
+
+FreeBusyPyramid::Node FreeBusyPyramid::query(int first, int last) const
+{
+    first = std::max(first, 0);
+    last = std::min(last, mSize);
+    if (first >= last) {
+        return {};
+    }
+
+    // the stretches at both ends may only be covered in part
+    const int firstStretch = stretchAt(first);
+    const int lastStretch = stretchAt(last - 1);
+    if (firstStretch == lastStretch) {
+        return stretchNode(firstStretch, last - first);
+    }
+
+    // walk up from both ends of the stretches in between, collecting the nodes
+    // on the left and on the right side in order, so free runs crossing node
+    // boundaries are joined correctly
+    Node left = stretchNode(firstStretch, stretchEnd(firstStretch) - first);
+    Node right = stretchNode(lastStretch, last - mStarts.at(lastStretch));
+    for (int l = firstStretch + 1 + mLeaves, r = lastStretch + mLeaves; l < r; l /= 2, r /= 2) {
+        if (l & 1) {
+            left = combine(left, mNodes.at(l++));
+        }
+        if (r & 1) {
+            right = combine(mNodes.at(--r), right);
+        }
+    }
+    return combine(left, right);
+}
+
+int FreeBusyPyramid::busyCount(int first, int last) const
+{
+    return query(first, last).busy;
+}
+
+int FreeBusyPyramid::longestFreeRun(int first, int last) const
+{
+    return query(first, last).longestFree;
+}
+
+QList<int> FreeBusyPyramid::busyCounts(int bucketSize) const
+{
+    QList<int> counts;
+    if (bucketSize <= 0 || mSize == 0) {
+        return counts;
+    }
+    counts.reserve((mSize + bucketSize - 1) / bucketSize);
+    for (int first = 0; first < mSize; first += bucketSize) {
+        counts.append(busyCount(first, first + bucketSize));
+    }
+    return counts;
+}
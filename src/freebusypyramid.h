@@ -0,0 +1,91 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "freebusybitmap.h"
+#include "incidenceeditor_private_export.h"
+
+#include <QList>
+
+namespace IncidenceEditorNG
+{
+/*!
+ * \class IncidenceEditorNG::FreeBusyPyramid
+ * \inmodule IncidenceEditor
+ * \internal
+ *
+ * A summary of a combined free/busy row for answering questions about any
+ * range of slots without scanning it.
+ *
+ * The row is split into stretches which are either completely free or
+ * completely busy. Every node of a segment tree over the stretches knows how
+ * many of its slots are busy and how long the free runs at its start, at its
+ * end and anywhere inside it are. Each level of the tree is the row at a
+ * coarser granularity than the level below, and range queries combine
+ * O(log n) nodes. The size of the tree only depends on the number of free
+ * runs, not on the number of slots.
+ */
+class INCIDENCEEDITOR_TESTS_EXPORT FreeBusyPyramid
+{
+public:
+    FreeBusyPyramid() = default;
+
+    /*!
+     * Builds the summary of a row of \a size slots which are free in
+     * \a freeRuns and busy everywhere else. \a freeRuns must be in ascending
+     * order and must not overlap.
+     */
+    FreeBusyPyramid(int size, const QList<FreeBusyBitmap::Run> &freeRuns);
+
+    /*!
+     * Builds the summary of \a busy.
+     */
+    explicit FreeBusyPyramid(const FreeBusyBitmap &busy);
+
+    /*!
+     * Returns the number of slots summarized, 0 for an empty summary.
+     */
+    [[nodiscard]] int size() const;
+
+    /*!
+     * Returns the number of busy slots from \a first up to, but not including, \a last.
+     */
+    [[nodiscard]] int busyCount(int first, int last) const;
+
+    /*!
+     * Returns the length of the longest run of free slots from \a first up to,
+     * but not including, \a last.
+     */
+    [[nodiscard]] int longestFreeRun(int first, int last) const;
+
+    /*!
+     * Returns the number of busy slots in each block of \a bucketSize slots,
+     * the last block may be shorter.
+     */
+    [[nodiscard]] QList<int> busyCounts(int bucketSize) const;
+
+private:
+    struct Node {
+        int length = 0;
+        int busy = 0;
+        int prefixFree = 0; //!< free slots at the start
+        int suffixFree = 0; //!< free slots at the end
+        int longestFree = 0;
+    };
+
+    [[nodiscard]] static Node combine(const Node &left, const Node &right);
+    [[nodiscard]] Node stretchNode(int stretch, int length) const;
+    [[nodiscard]] int stretchEnd(int stretch) const;
+    [[nodiscard]] int stretchAt(int slot) const;
+    [[nodiscard]] Node query(int first, int last) const;
+
+    QList<int> mStarts; //!< the first slot of every stretch, in ascending order
+    QList<Node> mNodes; //!< the root at 1, the children of i at 2i and 2i+1
+    int mLeaves = 0; //!< a power of two, the leaf of stretch i is mNodes[mLeaves + i]
+    int mSize = 0;
+};
+}
@@ -0,0 +1,843 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#include "freeslotsearch.h"
+#include "incidenceeditor_debug.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <queue>
+
+using namespace IncidenceEditorNG;
+
+FreeSlotSearch::FreeSlotSearch(const KCalendarCore::Period &timeframe, int resolutionSeconds, const QBitArray &weekdays, const QList<Attendee> &attendees)
+    : mTimeframe(timeframe)
+    , mResolutionSeconds(resolutionSeconds)
+    , mWeekdays(weekdays)
+    , mAllAttendees(attendees)
+{
+    Q_ASSERT(mResolutionSeconds > 0);
+    mAttendees.reserve(attendees.size());
+    for (const Attendee &attendee : attendees) {
+        if (attendee.mandatory) {
+            mAttendees.append(attendee);
+        }
+    }
+    // calculate the length of the timeframe in terms of the amount of timeslots.
+    // Example: 1 week timeframe, with resolution of 15 minutes
+    //          1 week = 10080 minutes / 15 = 672 15 min timeslots
+    //          So, the array would have a length of 672
+    mRange = mTimeframe.start().secsTo(mTimeframe.end()) / mResolutionSeconds;
+}
+
+void FreeSlotSearch::setEngine(Engine engine)
+{
+    mEngine = engine;
+}
+
+void FreeSlotSearch::setTileSize(int slots)
+{
+    mTileSize = std::max(slots, 1);
+}
+
+void FreeSlotSearch::setCountConflicts(bool countConflicts)
+{
+    mCountConflicts = countConflicts;
+}
+
+void FreeSlotSearch::setRanking(int durationSeconds, int count, const SlotWeights &weights)
+{
+    mRankedDurationSeconds = durationSeconds;
+    mRankedCount = count;
+    mSlotWeights = weights;
+}
+
+void FreeSlotSearch::setProgressive(int chunkSeconds, const BatchCallback &callback)
+{
+    mChunkSlots = chunkSeconds > 0 && callback ? std::max(chunkSeconds / mResolutionSeconds, 1) : 0;
+    mBatchCallback = callback;
+}
+
+void FreeSlotSearch::setRowCache(const RowCache &cache)
+{
+    mRowCache = cache;
+}
+
+FreeSlotSearch::RowCache FreeSlotSearch::rowCache() const
+{
+    return mRowCache;
+}
+
+void FreeSlotSearch::setGeneration(const std::shared_ptr<const std::atomic<quint64>> &latestGeneration, quint64 generation)
+{
+    mLatestGeneration = latestGeneration;
+    mGeneration = generation;
+}
+
+quint64 FreeSlotSearch::generation() const
+{
+    return mGeneration;
+}
+
+bool FreeSlotSearch::isCancelled() const
+{
+    return mLatestGeneration && mLatestGeneration->load(std::memory_order_relaxed) != mGeneration;
+}
+
+int FreeSlotSearch::conflictCount() const
+{
+    return mConflictCount;
+}
+
+bool FreeSlotSearch::hasFreeSlots() const
+{
+    return mHasFreeSlots;
+}
+
+KCalendarCore::Period::List FreeSlotSearch::freeSlots() const
+{
+    return mFreeSlots;
+}
+
+QList<FreeBusyBitmap::Run> FreeSlotSearch::freeRuns() const
+{
+    return mFreeRuns;
+}
+
+int FreeSlotSearch::slotCount() const
+{
+    return std::max(mRange, 0);
+}
+
+KCalendarCore::Period FreeSlotSearch::timeframe() const
+{
+    return mTimeframe;
+}
+
+int FreeSlotSearch::resolutionSeconds() const
+{
+    return mResolutionSeconds;
+}
+
+bool FreeSlotSearch::hasRankedSlots() const
+{
+    return mHasRankedSlots;
+}
+
+QList<FreeSlotSearch::RankedSlot> FreeSlotSearch::rankedSlots() const
+{
+    return mRankedSlots;
+}
+
+bool FreeSlotSearch::run()
+{
+    // Locates all free blocks in a given timeframe that match the search constraints.
+    // Every busy period is first mapped onto the slots of the timeframe (see slotSpan()),
+    // then one of two engines combines the rows:
+    // - the bitmap engine, O(p*n/64) (n number of attendees, p timeframe range / timeslot resolution):
+    //   1. convert each attendees schedule for the timeframe into a packed bitmap according to
+    //      the time resolution, where each time slot has a value of 1 = busy, 0 = free.
+    //   2. align the bitmaps vertically, and OR the columns 64 slots at a time
+    //   3. the resulting bitmap indicates whether anybody has a conflict at each timeslot
+    //   4. locate contiguous timeslots with a value of 0. these are the free time blocks.
+    // - the sweep engine, O(b*log n) (b total number of busy periods):
+    //   merges the sorted busy periods of all attendees and reports the gaps between them.
+    //   Its cost does not depend on the resolution or on the length of the timeframe.
+    if (mCountConflicts && !countConflicts()) {
+        return false;
+    }
+
+    mHasFreeSlots = false;
+    mFreeSlots.clear();
+    mFreeRuns.clear();
+    mHasRankedSlots = false;
+    mRankedSlots.clear();
+    if (mRange <= 0) {
+        return !isCancelled();
+    }
+
+    const QDateTime begin = mTimeframe.start();
+    qCDebug(INCIDENCEEDITOR_LOG) << "from " << begin << " to " << mTimeframe.end() << "; mResolutionSeconds = " << mResolutionSeconds
+                                 << "; range = " << mRange;
+
+    if (mRankedCount > 0 && !rankSlots()) {
+        return false;
+    }
+
+    // now we know the number of attendees we are calculating for
+    if (mAttendees.isEmpty()) {
+        qCDebug(INCIDENCEEDITOR_LOG) << "no attendees match search criteria";
+        return !isCancelled();
+    }
+    qCDebug(INCIDENCEEDITOR_LOG) << "num attendees: " << mAttendees.size();
+
+    // only the sweep engine finds the first free slots before it has seen the whole timeframe
+    const Engine engine = mChunkSlots > 0 ? Engine::Sweep : mEngine == Engine::Automatic ? selectEngine() : mEngine;
+    bool completed = false;
+    switch (engine) {
+    case Engine::Automatic:
+    case Engine::Bitmap:
+        qCDebug(INCIDENCEEDITOR_LOG) << "using bitmap engine";
+        completed = bitmapFreeRuns(mFreeRuns);
+        break;
+    case Engine::Sweep:
+        qCDebug(INCIDENCEEDITOR_LOG) << "using sweep engine";
+        completed = sweepFreeRuns(mFreeRuns);
+        break;
+    case Engine::Tiled:
+        qCDebug(INCIDENCEEDITOR_LOG) << "using tiled engine";
+        completed = tiledFreeRuns(mFreeRuns);
+        break;
+    }
+    if (!completed) {
+        return false;
+    }
+
+    // Finally, convert the free runs into date time ranges
+    mFreeSlots.reserve(mFreeRuns.size());
+    for (const FreeBusyBitmap::Run &run : std::as_const(mFreeRuns)) {
+        // push the free block onto the list
+        mFreeSlots << runPeriod(run);
+    }
+    mHasFreeSlots = true;
+    return !isCancelled();
+}
+
+bool FreeSlotSearch::countConflicts()
+{
+    // Every attendee is tried against the slot the previous attendees moved it to.
+    // An attendee who has to move it to their next free time has a conflict.
+    qint64 tryFrom = mTimeframe.start().toMSecsSinceEpoch();
+    const qint64 duration = mTimeframe.start().msecsTo(mTimeframe.end());
+    mConflictCount = 0;
+    for (const Attendee &attendee : std::as_const(mAttendees)) {
+        if (isCancelled()) {
+            return false;
+        }
+        const qint64 nextFree = attendee.busyIndex.nextFree(tryFrom, duration);
+        if (nextFree != tryFrom) {
+            tryFrom = nextFree;
+            ++mConflictCount;
+        }
+    }
+    return true;
+}
+
+namespace
+{
+using SlotSpan = std::pair<int, int>;
+
+// Sorts spans and merges the ones which overlap or touch.
+QList<SlotSpan> mergedSpans(QList<SlotSpan> spans)
+{
+    std::sort(spans.begin(), spans.end());
+    QList<SlotSpan> merged;
+    merged.reserve(spans.size());
+    for (const SlotSpan &span : std::as_const(spans)) {
+        if (!merged.isEmpty() && span.first <= merged.constLast().second) {
+            merged.last().second = std::max(merged.constLast().second, span.second);
+        } else {
+            merged.append(span);
+        }
+    }
+    return merged;
+}
+
+// Returns the parts of spans not covered by covered, both sorted and merged.
+QList<SlotSpan> subtractedSpans(const QList<SlotSpan> &spans, const QList<SlotSpan> &covered)
+{
+    QList<SlotSpan> result;
+    auto cover = covered.cbegin();
+    for (SlotSpan span : spans) {
+        while (cover != covered.cend() && cover->second <= span.first) {
+            ++cover;
+        }
+        for (auto it = cover; it != covered.cend() && it->first < span.second; ++it) {
+            if (it->first > span.first) {
+                result.append({span.first, it->first});
+            }
+            span.first = std::max(span.first, it->second);
+        }
+        if (span.first < span.second) {
+            result.append(span);
+        }
+    }
+    return result;
+}
+}
+
+bool FreeSlotSearch::rankSlots()
+{
+    // Candidates start on every slot and last for mRankedDurationSeconds, rounded up
+    // to whole slots. A busy span [a, b) hits the candidates starting in
+    // [a - length + 1, b), so every attendee adds its penalty to a few ranges of a
+    // difference array and one pass over the candidates sums them up.
+    const int length = (mRankedDurationSeconds + mResolutionSeconds - 1) / mResolutionSeconds;
+    const int candidates = mRange - length + 1;
+    if (length <= 0 || candidates <= 0) {
+        return !isCancelled();
+    }
+    const auto candidateSpan = [length, candidates](const SlotSpan &span) -> SlotSpan {
+        return {std::max(0, span.first - length + 1), std::min(span.second, candidates)};
+    };
+
+    // outside their working hours attendees count as busy
+    QList<std::pair<WorkingHours, QList<SlotSpan>>> hoursSpans;
+    const auto outsideHours = [&hoursSpans, this](const WorkingHours &hours) {
+        for (const auto &[knownHours, spans] : std::as_const(hoursSpans)) {
+            if (knownHours == hours) {
+                return spans;
+            }
+        }
+        hoursSpans.append({hours, unavailableSpans(hours)});
+        return hoursSpans.constLast().second;
+    };
+
+    QList<qint64> penaltyDelta(candidates + 1, 0);
+    const auto addPenalty = [&penaltyDelta](const QList<SlotSpan> &spans, qint64 penalty) {
+        for (const SlotSpan &span : spans) {
+            penaltyDelta[span.first] += penalty;
+            penaltyDelta[span.second] -= penalty;
+        }
+    };
+    for (const Attendee &attendee : std::as_const(mAllAttendees)) {
+        if (isCancelled()) {
+            return false;
+        }
+        QList<SlotSpan> busy;
+        QList<SlotSpan> tentative;
+        for (const KCalendarCore::FreeBusyPeriod &period : attendee.fullPeriods) {
+            const SlotSpan span = slotSpan(period);
+            if (span.first >= span.second) {
+                continue;
+            }
+            if (period.type() == KCalendarCore::FreeBusyPeriod::BusyTentative) {
+                tentative.append(candidateSpan(span));
+            } else {
+                busy.append(candidateSpan(span));
+            }
+        }
+        if (attendee.workingHours.restricts()) {
+            const QList<SlotSpan> spans = outsideHours(attendee.workingHours);
+            for (const SlotSpan &span : spans) {
+                busy.append(candidateSpan(span));
+            }
+        }
+        // an attendee costs its weight once per candidate, however many periods overlap it
+        busy = mergedSpans(busy);
+        tentative = subtractedSpans(mergedSpans(tentative), busy);
+        const qint64 weight = attendee.mandatory ? mSlotWeights.mandatoryBusy : mSlotWeights.optionalBusy;
+        addPenalty(busy, weight);
+        addPenalty(tentative, weight * mSlotWeights.tentativePercent / 100);
+    }
+
+    // candidates touching a disallowed weekday are never suggested
+    QList<int> blockedDelta(candidates + 1, 0);
+    const QList<SlotSpan> weekdaySpans = unavailableSpans(allowedWeekdays());
+    for (const SlotSpan &span : weekdaySpans) {
+        const SlotSpan blocked = candidateSpan(span);
+        ++blockedDelta[blocked.first];
+        --blockedDelta[blocked.second];
+    }
+
+    // Keep the best mRankedCount candidates in a bounded heap with the worst one on top.
+    struct Candidate {
+        qint64 penalty;
+        int start;
+    };
+    const auto isBetter = [](const Candidate &a, const Candidate &b) {
+        return a.penalty < b.penalty || (a.penalty == b.penalty && a.start < b.start);
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(isBetter)> heap(isBetter);
+    qint64 penalty = 0;
+    int blocked = 0;
+    for (int start = 0; start < candidates; ++start) {
+        if ((start & 0xfff) == 0 && isCancelled()) {
+            return false;
+        }
+        const qint64 previousPenalty = penalty;
+        const bool previousBlocked = blocked > 0;
+        penalty += penaltyDelta.at(start);
+        blocked += blockedDelta.at(start);
+        // consecutive candidates with the same penalty make one suggestion
+        if (blocked > 0 || (start > 0 && !previousBlocked && penalty == previousPenalty)) {
+            continue;
+        }
+        const Candidate candidate{penalty, start};
+        if (heap.size() < size_t(mRankedCount)) {
+            heap.push(candidate);
+        } else if (isBetter(candidate, heap.top())) {
+            heap.pop();
+            heap.push(candidate);
+        }
+    }
+
+    const QDateTime begin = mTimeframe.start();
+    mRankedSlots.resize(heap.size());
+    for (auto it = mRankedSlots.rbegin(); it != mRankedSlots.rend(); ++it) {
+        const Candidate &candidate = heap.top();
+        const QDateTime slotBegin = begin.addSecs(qint64(candidate.start) * mResolutionSeconds);
+        *it = {KCalendarCore::Period(slotBegin, slotBegin.addSecs(mRankedDurationSeconds)), candidate.penalty};
+        heap.pop();
+    }
+    mHasRankedSlots = true;
+    return true;
+}
+
+FreeSlotSearch::Engine FreeSlotSearch::selectEngine() const
+{
+    // Rough operation counts: the bitmap engine touches every word of every row,
+    // the sweep engine pays a heap operation per busy period. Both pay the same
+    // for the weekday and working hours masks.
+    qint64 totalBusyPeriods = 0;
+    for (const Attendee &attendee : mAttendees) {
+        totalBusyPeriods += attendee.periods.size();
+    }
+    const qint64 attendees = mAttendees.size();
+    const qint64 wordsPerRow = (mRange + 63) / 64;
+    const qint64 bitmapCost = (attendees + 1) * wordsPerRow + totalBusyPeriods;
+    const qint64 sweepCost = totalBusyPeriods * (65 - qCountLeadingZeroBits(quint64(attendees))) + 1;
+    if (sweepCost < bitmapCost) {
+        return Engine::Sweep;
+    }
+    // the bitmap engine keeps a full row per attendee, past a limit go tile by tile
+    static constexpr qint64 maxBitmapBytes = 64 * 1024 * 1024;
+    return (attendees + 1) * wordsPerRow * qint64(sizeof(quint64)) > maxBitmapBytes ? Engine::Tiled : Engine::Bitmap;
+}
+
+KCalendarCore::Period FreeSlotSearch::runPeriod(const FreeBusyBitmap::Run &run) const
+{
+    // convert from our timeslot interval back into to normal seconds
+    // then calculate the date times of the free block based on
+    // our initial timeframe
+    const QDateTime freeBegin = mTimeframe.start().addSecs(qint64(run.first) * mResolutionSeconds);
+    const QDateTime freeEnd = freeBegin.addSecs(qint64(run.second) * mResolutionSeconds);
+    return KCalendarCore::Period(freeBegin, freeEnd);
+}
+
+FreeSlotSearch::SlotSpan FreeSlotSearch::slotSpan(const KCalendarCore::Period &period) const
+{
+    const QDateTime begin = mTimeframe.start();
+    const QDateTime end = mTimeframe.end();
+    if (period.end() < begin || period.start() > end) {
+        return {0, 0};
+    }
+
+    int start_index = -1; // Initialize it to an invalid value.
+    int duration = -1; // Initialize it to an invalid value.
+    // case1: the period is completely in our timeframe
+    if (period.end() <= end && period.start() >= begin) {
+        start_index = begin.secsTo(period.start()) / mResolutionSeconds;
+        duration = period.start().secsTo(period.end()) / mResolutionSeconds;
+        duration -= 1; // vector starts at 0
+        // case2: the period begins before our timeframe begins
+    } else if (period.start() <= begin && period.end() <= end) {
+        start_index = 0;
+        duration = (begin.secsTo(period.end()) / mResolutionSeconds) - 1;
+        // case3: the period ends after our timeframe ends
+    } else if (period.end() >= end && period.start() >= begin) {
+        start_index = begin.secsTo(period.start()) / mResolutionSeconds;
+        duration = mRange - start_index - 1;
+        // case4: case2+case3: our timeframe is inside the period
+    } else if (period.start() <= begin && period.end() >= end) {
+        start_index = 0;
+        duration = mRange - 1;
+    } else {
+        // QT5
+        // qCCritical(INCIDENCEEDITOR_LOG) << "impossible condition reached" << period.start() << period.end();
+    }
+    //      qCDebug(INCIDENCEEDITOR_LOG) << start_index << "+" << duration << "="
+    //               << start_index + duration << "<=" << range;
+    Q_ASSERT((start_index + duration) < mRange); // sanity check
+    if (duration < 0) {
+        return {0, 0};
+    }
+    return {start_index, start_index + duration + 1};
+}
+
+FreeSlotSearch::WorkingHours FreeSlotSearch::allowedWeekdays() const
+{
+    WorkingHours hours;
+    hours.timeZone = mTimeframe.start().timeRepresentation();
+    hours.workDays = mWeekdays;
+    return hours;
+}
+
+QList<FreeSlotSearch::WorkingHours> FreeSlotSearch::mandatoryWorkingHours() const
+{
+    // the attendees of a team usually share their working hours, each set is masked once
+    QList<WorkingHours> result;
+    const WorkingHours weekdays = allowedWeekdays();
+    if (weekdays.restricts()) {
+        result.append(weekdays);
+    }
+    for (const Attendee &attendee : mAttendees) {
+        if (attendee.workingHours.restricts() && !result.contains(attendee.workingHours)) {
+            result.append(attendee.workingHours);
+        }
+    }
+    return result;
+}
+
+FreeBusyBitmap FreeSlotSearch::unavailableRow(const WorkingHours &hours, int first, int last) const
+{
+    // As long as the UTC offset does not change, whether a slot is available repeats
+    // every week, or every day if all days are work days. The pattern is evaluated
+    // once per stretch between two time zone transitions and tiled across it.
+    first = std::max(first, 0);
+    last = std::min(last, mRange);
+    FreeBusyBitmap row(std::max(last - first, 0));
+    if (first >= last || !hours.restricts()) {
+        return row;
+    }
+
+    const QDateTime begin = mTimeframe.start();
+    const QTimeZone zone = (hours.timeZone.isValid() ? hours.timeZone : begin.timeRepresentation()).asBackendZone();
+    const qint64 beginSecs = begin.toSecsSinceEpoch();
+    const qint64 firstSecs = beginSecs + qint64(first) * mResolutionSeconds;
+    const qint64 lastSecs = beginSecs + qint64(last) * mResolutionSeconds;
+
+    // the first second and the UTC offset of every stretch
+    QList<std::pair<qint64, int>> stretches{{firstSecs, zone.offsetFromUtc(QDateTime::fromSecsSinceEpoch(firstSecs, QTimeZone::utc()))}};
+    if (zone.hasTransitions()) {
+        const QTimeZone::OffsetDataList transitions =
+            zone.transitions(QDateTime::fromSecsSinceEpoch(firstSecs + 1, QTimeZone::utc()), QDateTime::fromSecsSinceEpoch(lastSecs - 1, QTimeZone::utc()));
+        for (const QTimeZone::OffsetData &transition : transitions) {
+            if (transition.offsetFromUtc != stretches.constLast().second) {
+                stretches.append({transition.atUtc.toSecsSinceEpoch(), transition.offsetFromUtc});
+            }
+        }
+    }
+
+    static constexpr qint64 secsPerDay = 24 * 60 * 60;
+    const bool window = hours.start.isValid() && hours.end.isValid() && hours.start < hours.end;
+    const qint64 windowStart = window ? hours.start.msecsSinceStartOfDay() / 1000 : 0;
+    const qint64 windowEnd = window ? hours.end.msecsSinceStartOfDay() / 1000 : secsPerDay;
+    const auto isAvailable = [&hours, window, windowStart, windowEnd, this](qint64 localSecs) {
+        qint64 day = localSecs / secsPerDay;
+        if (localSecs % secsPerDay < 0) {
+            --day;
+        }
+        // 1970-01-01 was a Thursday, bitarray is 0 indexed from Monday
+        if (!hours.workDays.testBit(((day + 3) % 7 + 7) % 7)) {
+            return false;
+        }
+        const qint64 secsOfDay = localSecs - day * secsPerDay;
+        return !window || (secsOfDay >= windowStart && secsOfDay + mResolutionSeconds <= windowEnd);
+    };
+
+    // Only a period of a whole number of slots can be tiled, other resolutions
+    // evaluate every slot.
+    const qint64 periodSecs = hours.workDays.count(true) < 7 ? 7 * secsPerDay : secsPerDay;
+    const bool periodic = periodSecs % mResolutionSeconds == 0;
+    for (qsizetype i = 0; i < stretches.size(); ++i) {
+        const auto &[stretchBegin, offset] = stretches.at(i);
+        const qint64 stretchEnd = i + 1 < stretches.size() ? stretches.at(i + 1).first : lastSecs;
+        // the slots starting inside the stretch
+        const int stretchFirst = std::max<qint64>(first, (stretchBegin - beginSecs + mResolutionSeconds - 1) / mResolutionSeconds);
+        const int stretchLast = std::min<qint64>(last, (stretchEnd - beginSecs + mResolutionSeconds - 1) / mResolutionSeconds);
+        if (stretchFirst >= stretchLast) {
+            continue;
+        }
+        const int length = periodic ? int(std::min<qint64>(periodSecs / mResolutionSeconds, stretchLast - stretchFirst)) : stretchLast - stretchFirst;
+        FreeBusyBitmap pattern(length);
+        const qint64 firstLocalSecs = beginSecs + qint64(stretchFirst) * mResolutionSeconds + offset;
+        for (int slot = 0; slot < length; ++slot) {
+            if (!isAvailable(firstLocalSecs + qint64(slot) * mResolutionSeconds)) {
+                pattern.setBit(slot);
+            }
+        }
+        row.tile(pattern, stretchFirst - first, stretchLast - first);
+    }
+    return row;
+}
+
+QList<FreeSlotSearch::SlotSpan> FreeSlotSearch::unavailableSpans(const WorkingHours &hours) const
+{
+    const QList<FreeBusyBitmap::Run> runs = unavailableRow(hours, 0, mRange).busyRuns();
+    QList<SlotSpan> spans;
+    spans.reserve(runs.size());
+    for (const FreeBusyBitmap::Run &run : runs) {
+        spans.append({run.first, run.first + run.second});
+    }
+    return spans;
+}
+
+bool FreeSlotSearch::bitmapFreeRuns(QList<FreeBusyBitmap::Run> &freeRuns)
+{
+    // The rows only depend on the attendee's free/busy data and on the slot grid,
+    // so they are kept between runs and only rebuilt when one of those changes.
+    if (mRowCache.timeframe != mTimeframe || mRowCache.resolutionSeconds != mResolutionSeconds) {
+        mRowCache = RowCache();
+        mRowCache.timeframe = mTimeframe;
+        mRowCache.resolutionSeconds = mResolutionSeconds;
+    }
+
+    // this is a 2 dimensional table where the rows are attendees
+    // and the columns are bits denoting free (0) or busy (1).
+    QList<FreeBusyBitmap> fbTable;
+    fbTable.reserve(mAttendees.size() + 1);
+    QHash<QString, CachedRow> usedRows;
+    usedRows.reserve(mAttendees.size());
+
+    // Explanation of the following loop:
+    // iterate: through each attendee
+    //   if: the cached row was built from the same free/busy revision
+    //   then: reuse it
+    //   else:
+    //     allocate: a bitmap of length <range> with every slot free
+    //     iterate: through each attendee's busy period
+    //       mark the slots covered by the period inside our timeframe as busy
+    //     etareti
+    //   fi
+    // append the bitmap to <fbTable>
+    // etareti
+    for (const Attendee &attendee : std::as_const(mAttendees)) {
+        if (isCancelled()) {
+            return false;
+        }
+        auto cached = mRowCache.rows.constFind(attendee.email);
+        if (cached == mRowCache.rows.cend() || cached->freeBusy != attendee.freeBusy || cached->revision != attendee.revision) {
+            FreeBusyBitmap fbArray(mRange);
+            for (const auto &period : attendee.periods) {
+                const SlotSpan span = slotSpan(period);
+                fbArray.fill(span.first, span.second);
+            }
+            cached = mRowCache.rows.insert(attendee.email, {attendee.freeBusy, attendee.revision, fbArray});
+        }
+        Q_ASSERT(cached->row.size() == mRange); // sanity check
+        fbTable.append(cached->row);
+        usedRows.insert(attendee.email, *cached);
+    }
+    // forget about attendees which are gone or don't match the constraints anymore
+    mRowCache.rows = usedRows;
+
+    Q_ASSERT(fbTable.size() == mAttendees.size());
+
+    // Now, add the bitmaps representing the allowed weekdays and the working hours
+    // of the attendees. All slots which are not allowed will be marked as busy.
+    const QList<WorkingHours> workingHours = mandatoryWorkingHours();
+    QList<CachedHoursRow> usedHoursRows;
+    usedHoursRows.reserve(workingHours.size());
+    for (const WorkingHours &hours : workingHours) {
+        const auto cached = std::find_if(mRowCache.hoursRows.cbegin(), mRowCache.hoursRows.cend(), [&hours](const CachedHoursRow &row) {
+            return row.hours == hours;
+        });
+        usedHoursRows.append(cached != mRowCache.hoursRows.cend() ? *cached : CachedHoursRow{hours, unavailableRow(hours, 0, mRange)});
+        fbTable.append(usedHoursRows.constLast().row);
+    }
+    mRowCache.hoursRows = usedHoursRows;
+
+    if (isCancelled()) {
+        return false;
+    }
+
+    // Create the composite bitmap that holds, for each timeslot,
+    // whether at least one row is busy
+    const FreeBusyBitmap summed = FreeBusyBitmap::united(fbTable, mRange);
+
+// NOLINTBEGIN(readability-avoid-unconditional-preprocessor-if)
+#if 0
+    //DEBUG, dump the arrays. very helpful for debugging
+    QTextStream dump(stdout);
+    dump << "    ";
+    dump.setFieldWidth(3);
+    for (int i = 0; i < mRange; ++i) {   // header
+        dump << i;
+    }
+    dump.setFieldWidth(1);
+    dump << "\n\n";
+    for (int i = 0; i < fbTable.size(); ++i) {
+        dump.setFieldWidth(1);
+        dump << i << ":  ";
+        dump.setFieldWidth(3);
+        for (int j = 0; j < mRange; ++j) {
+            dump << int(fbTable[i].testBit(j));
+        }
+        dump << "\n\n";
+    }
+    dump.setFieldWidth(1);
+    dump << "    ";
+    dump.setFieldWidth(3);
+    for (int i = 0; i < mRange; ++i) {
+        dump << int(summed.testBit(i));
+    }
+    dump << "\n";
+#endif
+    // NOLINTEND(readability-avoid-unconditional-preprocessor-if)
+
+    // Finally, walk the composite bitmap locating contiguous free timeslots
+    freeRuns = summed.freeRuns();
+    return true;
+}
+
+bool FreeSlotSearch::sweepFreeRuns(QList<FreeBusyBitmap::Run> &freeRuns) const
+{
+    // Map every attendee's busy periods onto sorted slot spans. The disallowed
+    // weekdays and every set of working hours are just one more row.
+    QList<QList<SlotSpan>> rows;
+    rows.reserve(mAttendees.size() + 1);
+    for (const Attendee &attendee : mAttendees) {
+        if (isCancelled()) {
+            return false;
+        }
+        QList<SlotSpan> spans;
+        spans.reserve(attendee.periods.size());
+        for (const auto &period : attendee.periods) {
+            const SlotSpan span = slotSpan(period);
+            if (span.first < span.second) {
+                spans.append(span);
+            }
+        }
+        if (!std::is_sorted(spans.cbegin(), spans.cend())) {
+            std::sort(spans.begin(), spans.end());
+        }
+        if (!spans.isEmpty()) {
+            rows.append(spans);
+        }
+    }
+    const QList<WorkingHours> workingHours = mandatoryWorkingHours();
+    for (const WorkingHours &hours : workingHours) {
+        const QList<SlotSpan> spans = unavailableSpans(hours);
+        if (!spans.isEmpty()) {
+            rows.append(spans);
+        }
+    }
+
+    // k-way merge of the rows by start slot: a gap between the slots covered so far
+    // and the next span to start is a free block.
+    struct Cursor {
+        int start;
+        int row;
+        int index;
+    };
+    const auto startsLater = [](const Cursor &a, const Cursor &b) {
+        return a.start > b.start;
+    };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(startsLater)> heap(startsLater);
+    for (int row = 0; row < rows.size(); ++row) {
+        heap.push({rows.at(row).constFirst().first, row, 0});
+    }
+
+    // In progressive mode, the runs found so far are reported whenever the sweep
+    // crosses into the next chunk. They are final, later spans all start after them.
+    int reported = 0;
+    int nextChunk = mChunkSlots;
+    const auto report = [&freeRuns, &reported, this]() {
+        if (reported == freeRuns.size()) {
+            return;
+        }
+        KCalendarCore::Period::List batch;
+        batch.reserve(freeRuns.size() - reported);
+        for (qsizetype i = reported; i < freeRuns.size(); ++i) {
+            batch << runPeriod(freeRuns.at(i));
+        }
+        mBatchCallback(reported, batch);
+        reported = freeRuns.size();
+    };
+
+    freeRuns.clear();
+    int covered = 0;
+    int steps = 0;
+    while (!heap.empty()) {
+        if ((++steps & 0xfff) == 0 && isCancelled()) {
+            return false;
+        }
+        Cursor cursor = heap.top();
+        heap.pop();
+        const QList<SlotSpan> &spans = rows.at(cursor.row);
+        const SlotSpan &span = spans.at(cursor.index);
+        if (span.first > covered) {
+            freeRuns.append({covered, span.first - covered});
+        }
+        covered = std::max(covered, span.second);
+        if (++cursor.index < spans.size()) {
+            cursor.start = spans.at(cursor.index).first;
+            heap.push(cursor);
+        }
+        if (mChunkSlots > 0 && covered >= nextChunk) {
+            if (isCancelled()) {
+                return false;
+            }
+            report();
+            nextChunk = (covered / mChunkSlots + 1) * mChunkSlots;
+        }
+    }
+    if (covered < mRange) {
+        freeRuns.append({covered, mRange - covered});
+    }
+    if (mChunkSlots > 0) {
+        report();
+    }
+    return true;
+}
+
+bool FreeSlotSearch::tiledFreeRuns(QList<FreeBusyBitmap::Run> &freeRuns)
+{
+    // The full rows are what this engine avoids, drop the ones kept by earlier searches.
+    mRowCache = RowCache();
+
+    // Every attendee's busy periods as sorted, disjoint slot spans, so each tile
+    // can pick up where the previous one stopped.
+    QList<QList<SlotSpan>> rows;
+    rows.reserve(mAttendees.size());
+    for (const Attendee &attendee : std::as_const(mAttendees)) {
+        if (isCancelled()) {
+            return false;
+        }
+        QList<SlotSpan> spans;
+        spans.reserve(attendee.periods.size());
+        for (const auto &period : attendee.periods) {
+            const SlotSpan span = slotSpan(period);
+            if (span.first < span.second) {
+                spans.append(span);
+            }
+        }
+        if (!spans.isEmpty()) {
+            rows.append(mergedSpans(spans));
+        }
+    }
+    QList<qsizetype> cursors(rows.size(), 0);
+    const QList<WorkingHours> workingHours = mandatoryWorkingHours();
+
+    freeRuns.clear();
+    for (int tileFirst = 0; tileFirst < mRange; tileFirst += mTileSize) {
+        if (isCancelled()) {
+            return false;
+        }
+        const int tileLast = std::min<qint64>(mRange, qint64(tileFirst) + mTileSize);
+
+        // rasterize the part of every row inside the tile straight into one bitmap
+        FreeBusyBitmap tile(tileLast - tileFirst);
+        for (qsizetype row = 0; row < rows.size(); ++row) {
+            const QList<SlotSpan> &spans = rows.at(row);
+            qsizetype &cursor = cursors[row];
+            for (; cursor < spans.size() && spans.at(cursor).first < tileLast; ++cursor) {
+                const SlotSpan &span = spans.at(cursor);
+                tile.fill(span.first - tileFirst, span.second - tileFirst);
+                if (span.second > tileLast) {
+                    break; // the span goes on in the next tile
+                }
+            }
+        }
+        for (const WorkingHours &hours : workingHours) {
+            tile.unite(unavailableRow(hours, tileFirst, tileLast));
+        }
+
+        // stitch runs which continue from the previous tile
+        const QList<FreeBusyBitmap::Run> tileRuns = tile.freeRuns();
+        for (const FreeBusyBitmap::Run &run : tileRuns) {
+            const int first = tileFirst + run.first;
+            if (!freeRuns.isEmpty() && freeRuns.constLast().first + freeRuns.constLast().second == first) {
+                freeRuns.last().second += run.second;
+            } else {
+                freeRuns.append({first, run.second});
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,320 @@
+/*
+  SPDX-FileCopyrightText: 2026 KDE PIM developers <kde-pim@kde.org>
+
+  SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "busyintervalindex.h"
+#include "freebusybitmap.h"
+
+#include <KCalendarCore/FreeBusy>
+#include <KCalendarCore/FreeBusyPeriod>
+#include <KCalendarCore/Period>
+
+#include <QBitArray>
+#include <QHash>
+#include <QTime>
+#include <QTimeZone>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace IncidenceEditorNG
+{
+/*!
+ * \class IncidenceEditorNG::FreeSlotSearch
+ * \inmodule IncidenceEditor
+ * \internal
+ *
+ * One conflict calculation of ConflictResolver, run over a snapshot of the
+ * free/busy data.
+ *
+ * Free slots are searched among the mandatory attendees only, while ranking
+ * takes everybody into account.
+ *
+ * The search holds its own copies of the timeframe, the constraints and the
+ * busy periods, so it can run on a worker thread while the resolver keeps
+ * changing. All copies are implicitly shared, taking the snapshot is cheap.
+ *
+ * A search can be tied to a generation counter; it gives up as soon as the
+ * counter no longer holds the generation it was started for.
+ */
+class FreeSlotSearch
+{
+public:
+    /*!
+     * The algorithms combining the busy periods, see ConflictResolver::FreeSlotEngine.
+     */
+    enum class Engine {
+        Automatic,
+        Bitmap,
+        Sweep,
+        Tiled,
+    };
+
+    /*!
+     * The number of slots the tiled engine processes at a time by default,
+     * 8 KiB per bitmap.
+     */
+    static constexpr int DefaultTileSize = 1 << 16;
+
+    /*!
+     * The hours an attendee can meet, in the attendee's own time zone.
+     *
+     * A slot is available if it starts on one of the work days and, if start
+     * and end are valid, lies between them completely. Without start and end
+     * the whole work day is available.
+     */
+    struct WorkingHours {
+        QTimeZone timeZone; //!< the zone start and end refer to, the timeframe's one if invalid
+        QBitArray workDays = QBitArray(7, true); //!< bit 0 is Monday
+        QTime start;
+        QTime end;
+
+        /*!
+         * Returns true if any slot can be outside these hours.
+         */
+        [[nodiscard]] bool restricts() const
+        {
+            return workDays.count(true) < 7 || (start.isValid() && end.isValid() && start < end);
+        }
+
+        [[nodiscard]] bool operator==(const WorkingHours &other) const
+        {
+            return timeZone == other.timeZone && workDays == other.workDays && start == other.start && end == other.end;
+        }
+    };
+
+    /*!
+     * The busy periods of one attendee taking part in the search.
+     */
+    struct Attendee {
+        QString email;
+        KCalendarCore::FreeBusy::Ptr freeBusy;
+        KCalendarCore::Period::List periods;
+        KCalendarCore::FreeBusyPeriod::List fullPeriods; //!< periods, with their busy type
+        BusyIntervalIndex busyIndex; //!< periods, sorted and merged
+        quint64 revision = 0; //!< changes whenever the attendee's free/busy data changes
+        bool mandatory = true; //!< whether the attendee matches the mandatory roles
+        WorkingHours workingHours; //!< the attendee is busy outside these
+    };
+
+    /*!
+     * The penalties used to rank candidate slots. A candidate overlapping a busy
+     * period of an attendee costs the weight of the attendee; a tentative busy
+     * period costs tentativePercent percent of it.
+     */
+    struct SlotWeights {
+        int mandatoryBusy = 100; //!< attendees matching the mandatory roles
+        int optionalBusy = 10; //!< all other attendees
+        int tentativePercent = 50;
+    };
+
+    /*!
+     * A candidate slot and the sum of its penalties, 0 if everybody is free.
+     */
+    struct RankedSlot {
+        KCalendarCore::Period period;
+        qint64 penalty = 0;
+    };
+
+    /*!
+     * A rasterized attendee row, valid as long as the attendee's free/busy data
+     * is the one it was built from.
+     */
+    struct CachedRow {
+        KCalendarCore::FreeBusy::Ptr freeBusy;
+        quint64 revision = 0;
+        FreeBusyBitmap row;
+    };
+
+    /*!
+     * The slots outside some working hours, see WorkingHours.
+     */
+    struct CachedHoursRow {
+        WorkingHours hours;
+        FreeBusyBitmap row;
+    };
+
+    /*!
+     * The rows built by the bitmap engine, handed from one search to the next.
+     */
+    struct RowCache {
+        KCalendarCore::Period timeframe; //!< the slot grid the rows were built for
+        int resolutionSeconds = 0;
+        QHash<QString, CachedRow> rows; //!< attendee email -> rasterized row
+        QList<CachedHoursRow> hoursRows; //!< the allowed weekdays and the attendees' working hours
+    };
+
+    FreeSlotSearch() = default;
+
+    /*!
+     * Creates a search for free slots of \a resolutionSeconds inside \a timeframe,
+     * on the \a weekdays allowed, among the given \a attendees.
+     */
+    FreeSlotSearch(const KCalendarCore::Period &timeframe, int resolutionSeconds, const QBitArray &weekdays, const QList<Attendee> &attendees);
+
+    /*!
+     * Selects the algorithm used to locate the free slots.
+     */
+    void setEngine(Engine engine);
+
+    /*!
+     * Sets the number of \a slots the tiled engine processes at a time.
+     */
+    void setTileSize(int slots);
+
+    /*!
+     * Whether run() counts the conflicts inside the timeframe as well. Default is false.
+     */
+    void setCountConflicts(bool countConflicts);
+
+    /*!
+     * Makes run() rank the candidate slots of \a durationSeconds and keep the
+     * \a count best ones. A \a count of 0, the default, disables ranking.
+     */
+    void setRanking(int durationSeconds, int count, const SlotWeights &weights);
+
+    /*!
+     * Receives the free slots found so far; \a first is the position of the first
+     * of \a slots in the complete list.
+     */
+    using BatchCallback = std::function<void(int first, const KCalendarCore::Period::List &slots)>;
+
+    /*!
+     * Makes run() report the free slots in batches while it walks the timeframe,
+     * about one batch per \a chunkSeconds. \a callback is called on the thread
+     * running the search. A \a chunkSeconds of 0, the default, reports nothing.
+     *
+     * Progressive searches use the sweep engine, which finds the free slots in
+     * ascending order.
+     */
+    void setProgressive(int chunkSeconds, const BatchCallback &callback);
+
+    /*!
+     * Lets the bitmap engine reuse the rows of an earlier search.
+     */
+    void setRowCache(const RowCache &cache);
+
+    /*!
+     * Returns the rows built by the last run(), to be handed to the next search.
+     */
+    [[nodiscard]] RowCache rowCache() const;
+
+    /*!
+     * Ties the search to \a generation of \a latestGeneration.
+     */
+    void setGeneration(const std::shared_ptr<const std::atomic<quint64>> &latestGeneration, quint64 generation);
+
+    /*!
+     * Returns the generation the search was started for.
+     */
+    [[nodiscard]] quint64 generation() const;
+
+    /*!
+     * Returns true if a newer generation has been started since this search was set up.
+     */
+    [[nodiscard]] bool isCancelled() const;
+
+    /*!
+     * Runs the search. Returns false if it was cancelled before it completed.
+     */
+    bool run();
+
+    /*!
+     * Returns the number of attendees with a conflict inside the timeframe.
+     * Only valid if conflicts were counted.
+     */
+    [[nodiscard]] int conflictCount() const;
+
+    /*!
+     * Returns false if there was nothing to search: the timeframe is shorter
+     * than one slot or no attendee has free/busy information.
+     */
+    [[nodiscard]] bool hasFreeSlots() const;
+
+    /*!
+     * Returns the free slots found, in ascending order.
+     */
+    [[nodiscard]] KCalendarCore::Period::List freeSlots() const;
+
+    /*!
+     * Returns the free slots found as runs of timeslots, in ascending order.
+     */
+    [[nodiscard]] QList<FreeBusyBitmap::Run> freeRuns() const;
+
+    /*!
+     * Returns the number of timeslots in the timeframe.
+     */
+    [[nodiscard]] int slotCount() const;
+
+    /*!
+     * Returns the timeframe searched.
+     */
+    [[nodiscard]] KCalendarCore::Period timeframe() const;
+
+    /*!
+     * Returns the length of one timeslot in seconds.
+     */
+    [[nodiscard]] int resolutionSeconds() const;
+
+    /*!
+     * Returns true if candidate slots were ranked.
+     */
+    [[nodiscard]] bool hasRankedSlots() const;
+
+    /*!
+     * Returns the best candidate slots, the lowest penalty first.
+     * Consecutive candidates with the same penalty are reported once, by the earliest of them.
+     */
+    [[nodiscard]] QList<RankedSlot> rankedSlots() const;
+
+private:
+    /*!
+     * A range of timeslots [first, last) inside the timeframe.
+     */
+    using SlotSpan = std::pair<int, int>;
+
+    [[nodiscard]] SlotSpan slotSpan(const KCalendarCore::Period &period) const;
+    [[nodiscard]] KCalendarCore::Period runPeriod(const FreeBusyBitmap::Run &run) const;
+    [[nodiscard]] WorkingHours allowedWeekdays() const;
+    [[nodiscard]] FreeBusyBitmap unavailableRow(const WorkingHours &hours, int first, int last) const;
+    [[nodiscard]] QList<SlotSpan> unavailableSpans(const WorkingHours &hours) const;
+    [[nodiscard]] QList<WorkingHours> mandatoryWorkingHours() const;
+    [[nodiscard]] Engine selectEngine() const;
+    [[nodiscard]] bool countConflicts();
+    [[nodiscard]] bool rankSlots();
+    [[nodiscard]] bool bitmapFreeRuns(QList<FreeBusyBitmap::Run> &freeRuns);
+    [[nodiscard]] bool sweepFreeRuns(QList<FreeBusyBitmap::Run> &freeRuns) const;
+    [[nodiscard]] bool tiledFreeRuns(QList<FreeBusyBitmap::Run> &freeRuns);
+
+    KCalendarCore::Period mTimeframe;
+    int mResolutionSeconds = 0;
+    int mRange = 0; //!< the number of slots in the timeframe
+    QBitArray mWeekdays;
+    QList<Attendee> mAttendees; //!< the mandatory attendees
+    QList<Attendee> mAllAttendees;
+    Engine mEngine = Engine::Automatic;
+    int mTileSize = DefaultTileSize;
+    bool mCountConflicts = false;
+    RowCache mRowCache;
+    int mRankedDurationSeconds = 0;
+    int mRankedCount = 0;
+    SlotWeights mSlotWeights;
+    int mChunkSlots = 0;
+    BatchCallback mBatchCallback;
+
+    std::shared_ptr<const std::atomic<quint64>> mLatestGeneration;
+    quint64 mGeneration = 0;
+
+    int mConflictCount = 0;
+    bool mHasFreeSlots = false;
+    KCalendarCore::Period::List mFreeSlots;
+    QList<FreeBusyBitmap::Run> mFreeRuns;
+    bool mHasRankedSlots = false;
+    QList<RankedSlot> mRankedSlots;
+};
+}
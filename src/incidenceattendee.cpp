@@ -17,7 +17,9 @@ using namespace Qt::Literals::StringLiterals;
 #include "attendeeeditor.h"
 #include "attendeelineeditdelegate.h"
 #include "attendeetablemodel.h"
+#include "attendeeutils.h"
 #include "conflictresolver.h"
+#include "contactgroupscheduler.h"
 #include "editorconfig.h"
 #include "incidencedatetime.h"
 #include "schedulingdialog.h"
@@ -25,8 +27,6 @@ using namespace Qt::Literals::StringLiterals;
 #include <CalendarSupport/FreeBusyItemModel>
 
 #include <Akonadi/AbstractEmailAddressSelectionDialog>
-#include <Akonadi/ContactGroupExpandJob>
-#include <Akonadi/ContactGroupSearchJob>
 #include <Akonadi/EmailAddressSelectionDialog>
 
 #if KCALENDARCORE_VERSION < QT_VERSION_CHECK(6, 30, 0)
@@ -41,10 +41,14 @@ using namespace Qt::Literals::StringLiterals;
 #include <QPointer>
 #include <QTreeView>
 
+#include <algorithm>
+
 Q_DECLARE_METATYPE(IncidenceEditorNG::EditorConfig::Organizer)
 
 using namespace IncidenceEditorNG;
 
+static constexpr int RECALCULATION_DELAY_MSECS = 200; // let date and time edits settle before searching again
+
 IncidenceAttendee::IncidenceAttendee(QWidget *parent, IncidenceDateTime *dateTime, Ui::EventOrTodoDesktop *ui)
     : mUi(ui)
     , mParentWidget(parent)
@@ -107,6 +111,7 @@ IncidenceAttendee::IncidenceAttendee(QWidget *parent, IncidenceDateTime *dateTim
     mUi->mOrganizerLabel->setVisible(false);
 
     mConflictResolver = new ConflictResolver(parent, parent);
+    mConflictResolver->setRecalculationDelay(RECALCULATION_DELAY_MSECS);
     mConflictResolver->setEarliestDate(mDateTime->startDate());
     mConflictResolver->setEarliestTime(mDateTime->startTime());
     mConflictResolver->setLatestDate(mDateTime->endDate());
@@ -128,12 +133,27 @@ IncidenceAttendee::IncidenceAttendee(QWidget *parent, IncidenceDateTime *dateTim
 
     connect(mConflictResolver, &ConflictResolver::conflictsDetected, this, &IncidenceAttendee::slotUpdateConflictLabel);
 
+    connect(ContactGroupScheduler::self(), &ContactGroupScheduler::groupsFound, this, &IncidenceAttendee::groupsFound);
+    connect(ContactGroupScheduler::self(), &ContactGroupScheduler::groupsExpanded, this, &IncidenceAttendee::groupsExpanded);
+
     connect(mConflictResolver->model(), &QAbstractItemModel::rowsInserted, this, &IncidenceAttendee::slotFreeBusyAdded);
     connect(mConflictResolver->model(), &QAbstractItemModel::layoutChanged, this, qOverload<>(&IncidenceAttendee::updateFBStatus));
     connect(mConflictResolver->model(), &QAbstractItemModel::dataChanged, this, &IncidenceAttendee::slotFreeBusyChanged);
 
     slotUpdateConflictLabel(0); // initialize label
 
+    // before anything else reacts to the change and may look rows up
+    connect(mDataModel, &AttendeeTableModel::layoutChanged, this, &IncidenceAttendee::invalidateAttendeeRows);
+    connect(mDataModel, &AttendeeTableModel::modelReset, this, &IncidenceAttendee::invalidateAttendeeRows);
+    connect(mDataModel, &AttendeeTableModel::rowsInserted, this, &IncidenceAttendee::invalidateAttendeeRows);
+    connect(mDataModel, &AttendeeTableModel::rowsRemoved, this, &IncidenceAttendee::invalidateAttendeeRows);
+    connect(mDataModel, &AttendeeTableModel::dataChanged, this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+        // updateFBStatus() only touches the Available column, which the lookup does not depend on
+        if (topLeft.column() != AttendeeTableModel::Available || bottomRight.column() != AttendeeTableModel::Available) {
+            invalidateAttendeeRows();
+        }
+    });
+
     // conflict resolver (should show also resources)
     connect(mDataModel, &AttendeeTableModel::layoutChanged, this, &IncidenceAttendee::slotConflictResolverLayoutChanged);
     connect(mDataModel, &AttendeeTableModel::modelReset, this, &IncidenceAttendee::slotConflictResolverLayoutChanged);
@@ -263,6 +283,7 @@ bool IncidenceAttendee::isDirty() const
     KCalendarCore::Attendee::List newList;
 
     const auto lstAttendees = mDataModel->attendees();
+    newList.reserve(lstAttendees.size());
     for (const KCalendarCore::Attendee &attendee : lstAttendees) {
         if (!attendee.fullName().isEmpty()) {
             newList.append(attendee);
@@ -271,29 +292,7 @@ bool IncidenceAttendee::isDirty() const
 
     // The lists sizes *must* be the same. When the organizer is attending the
     // event as well, he should be in the attendees list as well.
-    if (originalList.size() != newList.size()) {
-        return true;
-    }
-
-    // Okay, again not the most efficient algorithm, but I'm assuming that in the
-    // bulk of the use cases, the number of attendees is not much higher than 10 or so.
-    for (const KCalendarCore::Attendee &attendee : originalList) {
-        bool found = false;
-        for (int i = 0; i < newList.count(); ++i) {
-            if (newList[i] == attendee) {
-                newList.remove(i);
-                found = true;
-                break;
-            }
-        }
-
-        if (!found) {
-            // One of the attendees in the original list was not found in the new list.
-            return true;
-        }
-    }
-
-    return false;
+    return !sameAttendees(originalList, newList);
 }
 
 void IncidenceAttendee::changeStatusForMe(KCalendarCore::Attendee::PartStat stat)
@@ -344,47 +343,41 @@ void IncidenceAttendee::checkIfExpansionIsNeeded(const KCalendarCore::Attendee &
 {
     QString const fullname = attendee.fullName();
 
-    // stop old job
-    KJob *oldJob = mMightBeGroupJobs.key(attendee.uid());
-    if (oldJob != nullptr) {
-        disconnect(oldJob);
-        oldJob->deleteLater();
-        mMightBeGroupJobs.remove(oldJob);
-    }
-
+    // forget the old search, its result is ignored when it comes
+    mMightBeGroups.remove(attendee.uid());
     mGroupList.remove(attendee.uid());
 
     if (!fullname.isEmpty()) {
-        auto job = new Akonadi::ContactGroupSearchJob();
-        job->setQuery(Akonadi::ContactGroupSearchJob::Name, fullname);
-        connect(job, &Akonadi::ContactGroupSearchJob::result, this, &IncidenceAttendee::groupSearchResult);
-
-        mMightBeGroupJobs.insert(job, attendee.uid());
+        mMightBeGroups.insert(attendee.uid(), fullname);
+        ContactGroupScheduler::self()->findGroups(fullname);
     }
 }
 
-void IncidenceAttendee::groupSearchResult(KJob *job)
+void IncidenceAttendee::groupsFound(const QHash<QString, KContacts::ContactGroup::List> &groups)
 {
-    auto searchJob = qobject_cast<Akonadi::ContactGroupSearchJob *>(job);
-    Q_ASSERT(searchJob);
-
-    Q_ASSERT(mMightBeGroupJobs.contains(job));
-    const auto uid = mMightBeGroupJobs.take(job);
+    // look all rows up before changing any of them
+    QList<int> groupRows;
+    for (auto it = mMightBeGroups.begin(); it != mMightBeGroups.end();) {
+        const auto contactGroups = groups.constFind(it.value());
+        if (contactGroups == groups.cend()) {
+            ++it;
+            continue;
+        }
 
-    const KContacts::ContactGroup::List contactGroups = searchJob->contactGroups();
-    if (contactGroups.isEmpty()) {
-        updateGroupExpand();
-        return; // Nothing todo, probably a normal email address was entered
+        // an empty list means nothing todo, probably a normal email address was entered
+        const int row = rowOfAttendee(it.key());
+        if (!contactGroups->isEmpty() && row >= 0) {
+            // TODO: Give the user the possibility to choose a group when there is more than one?!
+            mGroupList.insert(it.key(), contactGroups->first());
+            groupRows.append(row);
+        }
+        it = mMightBeGroups.erase(it);
     }
 
-    // TODO: Give the user the possibility to choose a group when there is more than one?!
-    const KContacts::ContactGroup &group = contactGroups.first();
-
-    const int row = rowOfAttendee(uid);
-    QModelIndex const index = dataModel()->index(row, AttendeeTableModel::CuType);
-    dataModel()->setData(index, KCalendarCore::Attendee::Group);
-
-    mGroupList.insert(uid, group);
+    for (int row : std::as_const(groupRows)) {
+        QModelIndex const index = dataModel()->index(row, AttendeeTableModel::CuType);
+        dataModel()->setData(index, KCalendarCore::Attendee::Group);
+    }
     updateGroupExpand();
 }
 
@@ -396,45 +389,66 @@ void IncidenceAttendee::updateGroupExpand()
 void IncidenceAttendee::slotGroupSubstitutionPressed()
 {
     for (auto it = mGroupList.cbegin(), end = mGroupList.cend(); it != end; ++it) {
-        auto expandJob = new Akonadi::ContactGroupExpandJob(it.value(), this);
-        connect(expandJob, &Akonadi::ContactGroupExpandJob::result, this, &IncidenceAttendee::expandResult);
-        mExpandGroupJobs.insert(expandJob, it.key());
-        expandJob->start();
-    }
-}
-
-void IncidenceAttendee::expandResult(KJob *job)
-{
-    auto expandJob = qobject_cast<Akonadi::ContactGroupExpandJob *>(job);
-    Q_ASSERT(expandJob);
-    Q_ASSERT(mExpandGroupJobs.contains(job));
-    const auto uid = mExpandGroupJobs.take(job);
-    const int row = rowOfAttendee(uid);
-    const auto attendee = dataModel()->attendees().at(row);
-    const QString currentEmail = attendee.email();
-    const KContacts::Addressee::List groupMembers = expandJob->contacts();
-    bool wasACorrectEmail = false;
-    for (const KContacts::Addressee &member : groupMembers) {
-        if (member.preferredEmail() == currentEmail) {
-            wasACorrectEmail = true;
-            break;
-        }
+        mExpandingGroups.insert(it.key(), ContactGroupScheduler::groupKey(it.value()));
+        ContactGroupScheduler::self()->expandGroup(it.value());
     }
+}
 
-    if (!wasACorrectEmail) {
-        dataModel()->removeRow(row);
-        for (const KContacts::Addressee &member : groupMembers) {
-            KCalendarCore::Attendee const newAt(member.realName(), member.preferredEmail(), attendee.RSVP(), attendee.status(), attendee.role(), member.uid());
-            dataModel()->insertAttendee(row, newAt);
+void IncidenceAttendee::groupsExpanded(const QHash<QString, KContacts::Addressee::List> &members)
+{
+    // the rows to replace, all replaced at once when every group is looked at
+    QMap<int, KCalendarCore::Attendee::List> replacements;
+    for (auto it = mExpandingGroups.begin(); it != mExpandingGroups.end();) {
+        const auto groupMembers = members.constFind(it.value());
+        if (groupMembers == members.cend()) {
+            ++it;
+            continue;
+        }
+
+        const int row = rowOfAttendee(it.key());
+        it = mExpandingGroups.erase(it);
+        if (row < 0) {
+            continue;
+        }
+        QModelIndex const email = dataModel()->index(row, AttendeeTableModel::Email);
+        const auto attendee = dataModel()->data(email, AttendeeTableModel::AttendeeRole).value<KCalendarCore::Attendee>();
+        const QString currentEmail = attendee.email();
+        bool wasACorrectEmail = false;
+        for (const KContacts::Addressee &member : *groupMembers) {
+            if (member.preferredEmail() == currentEmail) {
+                wasACorrectEmail = true;
+                break;
+            }
+        }
+
+        if (!wasACorrectEmail) {
+            KCalendarCore::Attendee::List attendees;
+            attendees.reserve(groupMembers->size());
+            for (const KContacts::Addressee &member : *groupMembers) {
+                attendees.append(
+                    KCalendarCore::Attendee(member.realName(), member.preferredEmail(), attendee.RSVP(), attendee.status(), attendee.role(), member.uid()));
+            }
+            replacements.insert(row, attendees);
         }
     }
+
+    if (replacements.isEmpty()) {
+        return;
+    }
+    // the reset looks all rows up again, which forgets the groups still being expanded
+    const QHash<QString, QString> stillExpanding = mExpandingGroups;
+    dataModel()->replaceAttendees(replacements);
+    mExpandingGroups = stillExpanding;
 }
 
 void IncidenceAttendee::insertAddresses(const KContacts::Addressee::List &list)
 {
+    KCalendarCore::Attendee::List attendees;
+    attendees.reserve(list.size());
     for (const KContacts::Addressee &contact : list) {
-        insertAttendeeFromAddressee(contact);
+        attendees.append(attendeeFromAddressee(contact));
     }
+    dataModel()->insertAttendees(dataModel()->rowCount() - 1, attendees);
 }
 
 void IncidenceAttendee::slotSelectAddresses()
@@ -454,22 +468,24 @@ void IncidenceAttendee::slotSelectAddresses()
     connect(dialog.data(), &Akonadi::AbstractEmailAddressSelectionDialog::insertAddresses, this, &IncidenceEditorNG::IncidenceAttendee::insertAddresses);
     if (dialog->exec() == QDialog::Accepted) {
         const Akonadi::EmailAddressSelection::List list = dialog->selectedAddresses();
+        // the groups go to the top and the contacts to the end, each in one insertion
+        KCalendarCore::Attendee::List groups;
+        KContacts::ContactGroup::List contactGroups;
+        KCalendarCore::Attendee::List contacts;
         for (const Akonadi::EmailAddressSelection &selection : list) {
             if (selection.item().hasPayload<KContacts::ContactGroup>()) {
-                auto job = new Akonadi::ContactGroupExpandJob(selection.item().payload<KContacts::ContactGroup>(), this);
-                connect(job, &Akonadi::ContactGroupExpandJob::result, this, &IncidenceAttendee::expandResult);
+                const auto contactGroup = selection.item().payload<KContacts::ContactGroup>();
                 KCalendarCore::Attendee::PartStat const partStat = KCalendarCore::Attendee::NeedsAction;
                 bool const rsvp = true;
 
-                int const pos = 0;
                 QString name;
                 QString email;
                 KEmailAddress::extractEmailAddressAndName(selection.email(), email, name);
                 KCalendarCore::Attendee const newAt(selection.name(), email, rsvp, partStat, KCalendarCore::Attendee::ReqParticipant);
-                dataModel()->insertAttendee(pos, newAt);
+                groups.append(newAt);
 
-                mExpandGroupJobs.insert(job, newAt.uid());
-                job->start();
+                mExpandingGroups.insert(newAt.uid(), ContactGroupScheduler::groupKey(contactGroup));
+                contactGroups.append(contactGroup);
             } else {
                 KContacts::Addressee contact;
                 contact.setName(selection.name());
@@ -478,9 +494,14 @@ void IncidenceAttendee::slotSelectAddresses()
                 if (selection.item().hasPayload<KContacts::Addressee>()) {
                     contact.setUid(selection.item().payload<KContacts::Addressee>().uid());
                 }
-                insertAttendeeFromAddressee(contact);
+                contacts.append(attendeeFromAddressee(contact));
             }
         }
+        dataModel()->insertAttendees(0, groups);
+        dataModel()->insertAttendees(dataModel()->rowCount() - 1, contacts);
+        for (const KContacts::ContactGroup &contactGroup : std::as_const(contactGroups)) {
+            ContactGroupScheduler::self()->expandGroup(contactGroup);
+        }
     }
     delete dialog;
 }
@@ -533,7 +554,9 @@ void IncidenceAttendee::slotConflictResolverAttendeeRemoved(const QModelIndex &i
     for (int i = first; i <= last; ++i) {
         QModelIndex const email = dataModel()->index(i, AttendeeTableModel::Email, index);
         if (!dataModel()->data(email).toString().isEmpty()) {
-            mConflictResolver->removeAttendee(dataModel()->data(email, AttendeeTableModel::AttendeeRole).value<KCalendarCore::Attendee>());
+            const auto attendee = dataModel()->data(email, AttendeeTableModel::AttendeeRole).value<KCalendarCore::Attendee>();
+            mBusyIndexes.remove(attendee.email());
+            mConflictResolver->removeAttendee(attendee);
         }
     }
     checkDirtyStatus();
@@ -543,6 +566,7 @@ void IncidenceAttendee::slotConflictResolverLayoutChanged()
 {
     const KCalendarCore::Attendee::List attendees = mDataModel->attendees();
     mConflictResolver->clearAttendees();
+    mBusyIndexes.clear();
     for (const KCalendarCore::Attendee &attendee : attendees) {
         if (!attendee.email().isEmpty()) {
             mConflictResolver->insertAttendee(attendee);
@@ -600,33 +624,36 @@ void IncidenceAttendee::updateFBStatus()
 
 void IncidenceAttendee::updateFBStatus(const KCalendarCore::Attendee &attendee, const KCalendarCore::FreeBusy::Ptr &fb)
 {
-    KCalendarCore::Attendee::List const attendees = mDataModel->attendees();
-    QDateTime const startTime = mDateTime->currentStartDateTime();
-    QDateTime const endTime = mDateTime->currentEndDateTime();
-    if (attendees.contains(attendee)) {
-        int const row = dataModel()->attendees().indexOf(attendee);
-        QModelIndex const attendeeIndex = dataModel()->index(row, AttendeeTableModel::Available);
-        if (fb) {
-            KCalendarCore::Period::List busyPeriods = fb->busyPeriods();
-            for (auto it = busyPeriods.begin(); it != busyPeriods.end(); ++it) {
-                // periods started before and lapping into the incidence (s < startTime && e >= startTime)
-                // periods starting in the time of incidence (s >= startTime && s <= endTime)
-                if (((*it).start() < startTime && (*it).end() > startTime) || ((*it).start() >= startTime && (*it).start() <= endTime)) {
-                    switch (attendee.status()) {
-                    case KCalendarCore::Attendee::Accepted:
-                        dataModel()->setData(attendeeIndex, AttendeeTableModel::Accepted);
-                        return;
-                    default:
-                        dataModel()->setData(attendeeIndex, AttendeeTableModel::Busy);
-                        return;
-                    }
-                }
-            }
-            dataModel()->setData(attendeeIndex, AttendeeTableModel::Free);
-        } else {
-            dataModel()->setData(attendeeIndex, AttendeeTableModel::Unknown);
+    int const row = rowOfAttendee(attendee);
+    if (row < 0) {
+        return;
+    }
+    QModelIndex const attendeeIndex = dataModel()->index(row, AttendeeTableModel::Available);
+    if (!fb) {
+        mBusyIndexes.remove(attendee.email());
+        dataModel()->setData(attendeeIndex, AttendeeTableModel::Unknown);
+        return;
+    }
+
+    BusyIndex &busy = mBusyIndexes[attendee.email()];
+    if (busy.freeBusy != fb) {
+        busy.freeBusy = fb;
+        busy.index = BusyIntervalIndex(fb->busyPeriods());
+    }
+
+    // periods started before and lapping into the incidence (s < startTime && e > startTime)
+    // periods starting in the time of incidence (s >= startTime && s <= endTime)
+    if (busy.index.overlaps(mDateTime->currentStartDateTime().toMSecsSinceEpoch(), mDateTime->currentEndDateTime().toMSecsSinceEpoch())) {
+        switch (attendee.status()) {
+        case KCalendarCore::Attendee::Accepted:
+            dataModel()->setData(attendeeIndex, AttendeeTableModel::Accepted);
+            return;
+        default:
+            dataModel()->setData(attendeeIndex, AttendeeTableModel::Busy);
+            return;
         }
     }
+    dataModel()->setData(attendeeIndex, AttendeeTableModel::Free);
 }
 
 void IncidenceAttendee::slotUpdateConflictLabel(int count)
@@ -673,18 +700,8 @@ void IncidenceAttendee::slotGroupSubstitutionAttendeeRemoved([[maybe_unused]] co
     for (int i = first; i <= last; ++i) {
         QModelIndex const email = dataModel()->index(i, AttendeeTableModel::Email);
         auto attendee = dataModel()->data(email, AttendeeTableModel::AttendeeRole).value<KCalendarCore::Attendee>();
-        KJob *job = mMightBeGroupJobs.key(attendee.uid());
-        if (job) {
-            disconnect(job);
-            job->deleteLater();
-            mMightBeGroupJobs.remove(job);
-        }
-        job = mExpandGroupJobs.key(attendee.uid());
-        if (job) {
-            disconnect(job);
-            job->deleteLater();
-            mExpandGroupJobs.remove(job);
-        }
+        mMightBeGroups.remove(attendee.uid());
+        mExpandingGroups.remove(attendee.uid());
         mGroupList.remove(attendee.uid());
     }
     updateGroupExpand();
@@ -692,19 +709,8 @@ void IncidenceAttendee::slotGroupSubstitutionAttendeeRemoved([[maybe_unused]] co
 
 void IncidenceAttendee::slotGroupSubstitutionLayoutChanged()
 {
-    for (auto it = mMightBeGroupJobs.cbegin(), end = mMightBeGroupJobs.cend(); it != end; ++it) {
-        KJob *job = it.key();
-        disconnect(job);
-        job->deleteLater();
-    }
-
-    for (auto it = mExpandGroupJobs.cbegin(), end = mExpandGroupJobs.cend(); it != end; ++it) {
-        KJob *job = it.key();
-        disconnect(job);
-        job->deleteLater();
-    }
-    mMightBeGroupJobs.clear();
-    mExpandGroupJobs.clear();
+    mMightBeGroups.clear();
+    mExpandingGroups.clear();
     mGroupList.clear();
 
     const QAbstractItemModel *model = mUi->mAttendeeTable->model();
@@ -733,7 +739,7 @@ bool IncidenceAttendee::iAmOrganizer() const
     return true;
 }
 
-void IncidenceAttendee::insertAttendeeFromAddressee(const KContacts::Addressee &a, int pos /*=-1*/)
+KCalendarCore::Attendee IncidenceAttendee::attendeeFromAddressee(const KContacts::Addressee &a) const
 {
     const bool sameAsOrganizer = mUi->mOrganizerCombo && KEmailAddress::compareEmail(a.preferredEmail(), mUi->mOrganizerCombo->currentText(), false);
     KCalendarCore::Attendee::PartStat partStat = KCalendarCore::Attendee::NeedsAction;
@@ -747,12 +753,7 @@ void IncidenceAttendee::insertAttendeeFromAddressee(const KContacts::Addressee &
     QString email;
     KEmailAddress::extractEmailAddressAndName(a.preferredEmail(), email, name);
 
-    KCalendarCore::Attendee const newAt(a.realName(), email, rsvp, partStat, KCalendarCore::Attendee::ReqParticipant, a.uid());
-    if (pos < 0) {
-        pos = dataModel()->rowCount() - 1;
-    }
-
-    dataModel()->insertAttendee(pos, newAt);
+    return KCalendarCore::Attendee(a.realName(), email, rsvp, partStat, KCalendarCore::Attendee::ReqParticipant, a.uid());
 }
 
 void IncidenceAttendee::slotEventDurationChanged()
@@ -978,13 +979,49 @@ void IncidenceAttendee::printDebugInfo() const
     }
 }
 
-int IncidenceAttendee::rowOfAttendee(const QString &uid) const
+int IncidenceAttendee::rowOfAttendee(const QString &uid)
 {
-    const auto attendees = dataModel()->attendees();
-    const auto it = std::find_if(attendees.begin(), attendees.end(), [uid](const KCalendarCore::Attendee &att) {
-        return att.uid() == uid;
-    });
-    return std::distance(attendees.begin(), it);
+    updateAttendeeRows();
+    int found = -1;
+    for (auto it = mAttendeeRows.constFind(uid); it != mAttendeeRows.cend() && it.key() == uid; ++it) {
+        if (found < 0 || it.value() < found) {
+            found = it.value();
+        }
+    }
+    return found;
+}
+
+int IncidenceAttendee::rowOfAttendee(const KCalendarCore::Attendee &attendee)
+{
+    updateAttendeeRows();
+
+    // attendees sharing the uid are told apart like QList::indexOf() does
+    const KCalendarCore::Attendee::List attendees = dataModel()->attendees();
+    int found = -1;
+    for (auto it = mAttendeeRows.constFind(attendee.uid()); it != mAttendeeRows.cend() && it.key() == attendee.uid(); ++it) {
+        if ((found < 0 || it.value() < found) && attendees.at(it.value()) == attendee) {
+            found = it.value();
+        }
+    }
+    return found;
+}
+
+void IncidenceAttendee::updateAttendeeRows()
+{
+    if (!mAttendeeRowsValid) {
+        const KCalendarCore::Attendee::List attendees = dataModel()->attendees();
+        mAttendeeRows.clear();
+        mAttendeeRows.reserve(attendees.size());
+        for (int row = 0; row < attendees.size(); ++row) {
+            mAttendeeRows.insert(attendees.at(row).uid(), row);
+        }
+        mAttendeeRowsValid = true;
+    }
+}
+
+void IncidenceAttendee::invalidateAttendeeRows()
+{
+    mAttendeeRowsValid = false;
 }
 
 void IncidenceAttendee::slotUpdateCryptoPreferences()
@@ -7,23 +7,20 @@
 
 #pragma once
 
+#include "busyintervalindex.h"
 #include "incidenceeditor-ng.h"
 
 #include <KCalendarCore/FreeBusy>
 #include <KContacts/Addressee>
+#include <KContacts/ContactGroup>
+
+#include <QHash>
+#include <QMultiHash>
 namespace Ui
 {
 class EventOrTodoDesktop;
 }
 
-namespace KContacts
-{
-class Addressee;
-class ContactGroup;
-}
-
-class KJob;
-
 namespace IncidenceEditorNG
 {
 class AttendeeComboBoxDelegate;
@@ -67,9 +64,9 @@ private:
     // checks if row is a group,  that can/should be expanded
     void checkIfExpansionIsNeeded(const KCalendarCore::Attendee &attendee);
 
-    // results of the group search job
-    void groupSearchResult(KJob *job);
-    void expandResult(KJob *job);
+    // results of the group searches and expansions
+    void groupsFound(const QHash<QString, KContacts::ContactGroup::List> &groups);
+    void groupsExpanded(const QHash<QString, KContacts::Addressee::List> &members);
     void slotSelectAddresses();
     void slotSolveConflictPressed();
     void slotUpdateConflictLabel(int);
@@ -107,18 +104,19 @@ private:
     /** Returns if I was the organizer of the loaded event */
     [[nodiscard]] bool iAmOrganizer() const;
 
-    /** Reads values from a KContacts::Addressee and inserts a new Attendee
-     * item into the listview with those items. Used when adding attendees
-     * from the addressbook and expanding distribution lists.
-     * The optional Attendee parameter can be used to pass in default values
-     * to be used by the new Attendee.
-     * pos =-1 means insert attendee before empty line
+    /** Reads values from a KContacts::Addressee and returns a new Attendee
+     * with those items. Used when adding attendees from the addressbook.
      */
-    void insertAttendeeFromAddressee(const KContacts::Addressee &a, int pos = -1);
+    [[nodiscard]] KCalendarCore::Attendee attendeeFromAddressee(const KContacts::Addressee &a) const;
     void fillOrganizerCombo();
     void setActions(KCalendarCore::Incidence::IncidenceType actions);
 
-    int rowOfAttendee(const QString &uid) const;
+    /** Returns the first row of the attendee with \a uid, or -1. */
+    [[nodiscard]] int rowOfAttendee(const QString &uid);
+    /** Returns the row of the first attendee equal to \a attendee, or -1. */
+    [[nodiscard]] int rowOfAttendee(const KCalendarCore::Attendee &attendee);
+    void updateAttendeeRows();
+    void invalidateAttendeeRows();
 
     Ui::EventOrTodoDesktop *mUi = nullptr;
     QWidget *mParentWidget = nullptr;
@@ -136,7 +134,19 @@ private:
 
     // the QString is Attendee::uid here
     QMap<QString, KContacts::ContactGroup> mGroupList;
-    QMap<KJob *, QString> mMightBeGroupJobs;
-    QMap<KJob *, QString> mExpandGroupJobs;
+    // the names looked up, and the keys of the groups expanded by ContactGroupScheduler
+    QHash<QString, QString> mMightBeGroups;
+    QHash<QString, QString> mExpandingGroups;
+
+    // the rows of the attendee table by Attendee::uid, built when needed
+    QMultiHash<QString, int> mAttendeeRows;
+    bool mAttendeeRowsValid = false;
+
+    struct BusyIndex {
+        KCalendarCore::FreeBusy::Ptr freeBusy;
+        BusyIntervalIndex index;
+    };
+    // the busy periods of each attendee by email, rebuilt when the free/busy list changes
+    QHash<QString, BusyIndex> mBusyIndexes;
 };
 }
@@ -5,6 +5,7 @@
  */
 
 #include "resourcemanagement.h"
+#include "freebusycache.h"
 #include "ldaputils.h"
 #include "resourcemodel.h"
 #include "ui_resourcemanagement.h"
@@ -217,7 +218,7 @@ void ResourceManagement::showDetails(const KLDAPCore::LdapObject &obj, const KLD
     QString const name = QString::fromUtf8(obj.attributes().value(u"cn"_s).at(0));
     QString const email = QString::fromUtf8(obj.attributes().value(u"mail"_s).at(0));
     KCalendarCore::Attendee const attendee(name, email);
-    CalendarSupport::FreeBusyItem::Ptr const freebusy(new CalendarSupport::FreeBusyItem(attendee, this));
+    CalendarSupport::FreeBusyItem::Ptr const freebusy = FreeBusyCache::self()->createItem(attendee, {}, this);
     mModel->clear();
     mModel->addItem(freebusy);
 }
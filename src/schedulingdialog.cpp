@@ -24,6 +24,9 @@ using namespace Qt::Literals::StringLiterals;
 
 using namespace IncidenceEditorNG;
 
+static constexpr int SUGGESTED_SLOT_COUNT = 10; // slots suggested when nobody is free for the whole meeting
+static constexpr int PROGRESSIVE_CHUNK_SECONDS = 7 * 24 * 60 * 60; // show the free slots a week at a time
+
 SchedulingDialog::SchedulingDialog(QDate startDate, QTime startTime, int duration, ConflictResolver *resolver, QWidget *parent)
     : QDialog(parent)
     , mResolver(resolver)
@@ -64,6 +67,23 @@ SchedulingDialog::SchedulingDialog(QDate startDate, QTime startTime, int duratio
     connect(mWeekdayCombo, &IncidenceEditorNG::KWeekdayCheckCombo::checkedItemsChanged, this, &SchedulingDialog::slotMandatoryRolesChanged);
 
     connect(mResolver, &ConflictResolver::freeSlotsAvailable, mPeriodModel, &CalendarSupport::FreePeriodModel::slotNewFreePeriods);
+    connect(mResolver, &ConflictResolver::freeSlotsBatchAvailable, this, [this](int first, const KCalendarCore::Period::List &slots) {
+        mPartialSlots.resize(first);
+        mPartialSlots += slots;
+        mPeriodModel->slotNewFreePeriods(mPartialSlots);
+    });
+    connect(mResolver, &ConflictResolver::rankedSlotsAvailable, this, [this](const QList<ConflictResolver::RankedSlot> &rankedSlots) {
+        // only fall back to the best compromises when nobody is free
+        if (!mResolver->availableSlots().isEmpty()) {
+            return;
+        }
+        KCalendarCore::Period::List periods;
+        periods.reserve(rankedSlots.size());
+        for (const ConflictResolver::RankedSlot &slot : rankedSlots) {
+            periods << slot.period;
+        }
+        mPeriodModel->slotNewFreePeriods(periods);
+    });
     connect(mMoveBeginTimeEdit, &KTimeComboBox::timeEdited, this, &SchedulingDialog::slotSetEndTimeLabel);
 
     mTableView->setModel(mPeriodModel);
@@ -74,6 +94,8 @@ SchedulingDialog::SchedulingDialog(QDate startDate, QTime startTime, int duratio
     mStartTime->setTime(startTime);
     mEndTime->setTime(startTime);
 
+    mResolver->setRankedSlotSearch(mDuration, SUGGESTED_SLOT_COUNT);
+    mResolver->setProgressiveSearch(PROGRESSIVE_CHUNK_SECONDS);
     mResolver->setEarliestDate(mStartDate->date());
     mResolver->setEarliestTime(mStartTime->time());
     mResolver->setLatestDate(mEndDate->date());
@@ -82,7 +104,12 @@ SchedulingDialog::SchedulingDialog(QDate startDate, QTime startTime, int duratio
     mMoveApptGroupBox->hide();
 }
 
-SchedulingDialog::~SchedulingDialog() = default;
+SchedulingDialog::~SchedulingDialog()
+{
+    // the resolver outlives the dialog, stop ranking and reporting slots nobody looks at
+    mResolver->setRankedSlotSearch(0, 0);
+    mResolver->setProgressiveSearch(0);
+}
 
 void SchedulingDialog::slotUpdateIncidenceStartEnd(const QDateTime &startDateTime, const QDateTime &endDateTime)
 {
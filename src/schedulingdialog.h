@@ -59,6 +59,7 @@ private:
 
     ConflictResolver *const mResolver;
     CalendarSupport::FreePeriodModel *const mPeriodModel;
+    KCalendarCore::Period::List mPartialSlots; //!< the free slots reported so far by a running calculation
     VisualFreeBusyWidget *mVisualWidget = nullptr;
 };
 }
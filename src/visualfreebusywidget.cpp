@@ -29,8 +29,12 @@ using namespace Qt::Literals::StringLiterals;
 #include <QTreeView>
 #include <QVBoxLayout>
 
+#include <algorithm>
+
 using namespace IncidenceEditorNG;
 
+static constexpr int ROW_OVERSCAN = 20; // attendees above and below the view whose periods are shown too
+
 namespace IncidenceEditorNG
 {
 class RowController : public KGantt::AbstractRowController
@@ -105,6 +109,11 @@ public:
         mRowHeight = height;
     }
 
+    [[nodiscard]] int rowHeight() const
+    {
+        return mRowHeight;
+    }
+
 private:
     int mRowHeight;
 };
@@ -203,6 +212,7 @@ VisualFreeBusyWidget::VisualFreeBusyWidget(CalendarSupport::FreeBusyItemModel *m
     mLeftView->setToolTip(i18nc("@info:tooltip", "Shows the tree list of all data"));
     mLeftView->setWhatsThis(i18nc("@info:whatsthis", "Shows the tree list of all data"));
     mLeftView->setRootIsDecorated(false);
+    mLeftView->setUniformRowHeights(true); // does not need to measure every attendee
     mLeftView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     mLeftView->setContextMenuPolicy(Qt::CustomContextMenu);
     mGanttGraphicsView = new KGantt::GraphicsView(this);
@@ -242,6 +252,21 @@ VisualFreeBusyWidget::VisualFreeBusyWidget(CalendarSupport::FreeBusyItemModel *m
     mGanttGrid->setStartDateTime(horizonStart);
 
     connect(mLeftView, &QTreeView::customContextMenuRequested, this, &VisualFreeBusyWidget::showAttendeeStatusMenu);
+
+    // only the periods around what is on screen become gantt items
+    connect(mGanttGraphicsView->horizontalScrollBar(), &QScrollBar::valueChanged, this, [this]() {
+        updateVisibleRange(false);
+    });
+    connect(mGanttGrid, &KGantt::AbstractGrid::gridChanged, this, [this]() {
+        updateVisibleRange(true);
+    });
+    updateVisibleRange(true);
+
+    // and only for the attendees on screen
+    connect(mGanttGraphicsView->verticalScrollBar(), &QScrollBar::valueChanged, this, [this]() {
+        updateVisibleRows(false);
+    });
+    updateVisibleRows(true);
 }
 
 VisualFreeBusyWidget::~VisualFreeBusyWidget()
@@ -280,6 +305,41 @@ void VisualFreeBusyWidget::slotScaleChanged(int newScale)
 
     int const value = var.toInt();
     mGanttGrid->setScale((KGantt::DateTimeGrid::Scale)value);
+    // from a day per screen on, overlapping or touching periods cannot be told apart
+    mModel->setMergePeriods(value == KGantt::DateTimeGrid::ScaleDay || value == KGantt::DateTimeGrid::ScaleWeek
+                            || value == KGantt::DateTimeGrid::ScaleMonth);
+}
+
+void VisualFreeBusyWidget::updateVisibleRange(bool force)
+{
+    const int left = mGanttGraphicsView->horizontalScrollBar()->value();
+    const int width = mGanttGraphicsView->width();
+    const QDateTime start = mGanttGrid->mapToDateTime(left);
+    const QDateTime end = mGanttGrid->mapToDateTime(left + width);
+    if (!force && mModel->visibleStart().isValid() && start >= mModel->visibleStart() && end <= mModel->visibleEnd()) {
+        return;
+    }
+    // take a screen more on both sides, so scrolling does not filter again on every step
+    mModel->setVisibleRange(mGanttGrid->mapToDateTime(left - width), mGanttGrid->mapToDateTime(left + 2 * width));
+}
+
+void VisualFreeBusyWidget::updateVisibleRows(bool force)
+{
+    const int rowHeight = std::max(mRowController->rowHeight(), 1);
+    const int top = mGanttGraphicsView->verticalScrollBar()->value();
+    const int first = top / rowHeight;
+    const int last = (top + mGanttGraphicsView->viewport()->height()) / rowHeight;
+    if (!force && mModel->firstVisibleRow() >= 0 && first >= mModel->firstVisibleRow() && last <= mModel->lastVisibleRow()) {
+        return;
+    }
+    mModel->setVisibleRows(std::max(first - ROW_OVERSCAN, 0), last + ROW_OVERSCAN);
+}
+
+void VisualFreeBusyWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateVisibleRange(false);
+    updateVisibleRows(false);
 }
 
 void VisualFreeBusyWidget::slotUpdateIncidenceStartEnd(const QDateTime &dtFrom, const QDateTime &dtTo)
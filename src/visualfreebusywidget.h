@@ -7,6 +7,8 @@
 
 #pragma once
 
+#include "incidenceeditor_private_export.h"
+
 #include <QDateTime>
 #include <QWidget>
 
@@ -29,7 +31,7 @@ namespace IncidenceEditorNG
 class FreeBusyGanttProxyModel;
 class RowController;
 
-class VisualFreeBusyWidget : public QWidget
+class INCIDENCEEDITOR_TESTS_EXPORT VisualFreeBusyWidget : public QWidget
 {
     Q_OBJECT
 public:
@@ -51,8 +53,21 @@ protected Q_SLOTS:
     void showAttendeeStatusMenu();
     void slotIntervalColorRectangleMoved(const QDateTime &start, const QDateTime &end);
 
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+
 private:
     void splitterMoved();
+    /*!
+     * Limits the gantt items to the periods around the visible part of the chart,
+     * unless it still lies within the current range and \a force is false.
+     */
+    void updateVisibleRange(bool force);
+    /*!
+     * Limits the gantt items to the attendees around the visible rows, unless
+     * these still lie within the current rows and \a force is false.
+     */
+    void updateVisibleRows(bool force);
     KGantt::GraphicsView *mGanttGraphicsView = nullptr;
     QTreeView *mLeftView = nullptr;
     RowController *mRowController = nullptr;